@@ -0,0 +1,151 @@
+#include <CTileGrid.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// micro benchmark of CTileGrid bulk operations (replace, clear, fill,
+// duplicate row removal and copy) for each cell size, and of small (inline)
+// grid copies against heap grids
+
+namespace {
+
+// run function and return average time per call in microseconds
+template<typename FN>
+double
+timeIt(int n, FN fn)
+{
+  auto t1 = std::chrono::steady_clock::now();
+
+  for (int i = 0; i < n; ++i)
+    fn(i);
+
+  auto t2 = std::chrono::steady_clock::now();
+
+  return std::chrono::duration<double, std::micro>(t2 - t1).count()/n;
+}
+
+// make grid with n x n tiles of 8 x 8 cells (ids 1 ... n*n)
+template<typename GRID>
+GRID
+makeGrid(int size)
+{
+  GRID grid(size, size);
+
+  grid.clear();
+
+  int id = 1;
+
+  for (int r = 0; r < size; r += 8)
+    for (int c = 0; c < size; c += 8)
+      grid.fill(r, c, r + 7, c + 7, id++);
+
+  return grid;
+}
+
+template<typename GRID>
+void
+benchSize(int size, int n)
+{
+  GRID grid = makeGrid<GRID>(size);
+
+  int numIds = (size/8)*(size/8);
+
+  // swap id of left half of grid back and forth (with id in grid so cells
+  // are changed)
+  grid.fill(0, 0, size - 1, size/2 - 1, 1);
+
+  double replaceTime = timeIt(n, [&](int i) {
+    if (i & 1) grid.replace(-1, 1);
+    else       grid.replace(1, -1);
+  });
+
+  // full grid clear
+  double clearTime = timeIt(n, [&](int i) {
+    grid.clear(i & 1);
+  });
+
+  // fill full row spans with changing ids
+  grid = makeGrid<GRID>(size);
+
+  double fillTime = timeIt(n, [&](int i) {
+    int r = (i*7) % (size - 8);
+
+    grid.fill(r, 0, r + 7, size - 1, 1 + (i % numIds));
+  });
+
+  // remove duplicate rows/columns from grid with 8x duplicates
+  GRID grid1 = makeGrid<GRID>(size);
+
+  double dupTime = timeIt(n, [&](int) {
+    GRID grid2 = grid1;
+
+    grid2.removeDuplicateRows();
+    grid2.removeDuplicateCols();
+  });
+
+  // copy grid (as for saved placement state)
+  std::vector<GRID> grids(4);
+
+  double copyTime = timeIt(n, [&](int i) {
+    grids[uint(i & 3)] = grid1;
+  });
+
+  printf("  %2d bit  %3dx%-3d  replace %9.2f  clear %9.2f  fill %9.2f  dups %9.2f  copy %9.2f\n",
+         int(8*sizeof(typename GRID::Cell)), size, size,
+         replaceTime, clearTime, fillTime, dupTime, copyTime);
+}
+
+// copy and edit small grid (as for saved state of typical 3x3 layout)
+template<typename GRID>
+void
+benchSmall(const char *name, int n)
+{
+  GRID grid(3, 3);
+
+  grid.clear();
+
+  for (int r = 0; r < 3; ++r)
+    for (int c = 0; c < 3; ++c)
+      grid.setCell(r, c, 1 + r*3 + c);
+
+  std::vector<GRID> grids(4);
+
+  double copyTime = timeIt(n, [&](int i) {
+    grids[uint(i & 3)] = grid;
+  });
+
+  double editTime = timeIt(n, [&](int i) {
+    GRID grid1 = grid;
+
+    grid1.fill(0, 0, 0, 2, 1 + (i % 9));
+    grid1.removeDuplicateRows();
+  });
+
+  printf("  %-6s   3x3      copy %9.3f  copy+edit %9.3f\n", name, copyTime, editTime);
+}
+
+}
+
+int
+main(int argc, char **argv)
+{
+  int n = (argc > 1 ? atoi(argv[1]) : 2000);
+
+  printf("times in microseconds per call\n");
+
+  printf("grid\n");
+
+  benchSize<CTileGridT<int16_t>>( 64, n);
+  benchSize<CTileGridT<int32_t>>( 64, n);
+  benchSize<CTileGridT<int16_t>>(256, n/8 > 0 ? n/8 : 1);
+  benchSize<CTileGridT<int32_t>>(256, n/8 > 0 ? n/8 : 1);
+
+  printf("small grid\n");
+
+  benchSmall<CTileGridT<int16_t>   >("inline", 50*n);
+  benchSmall<CTileGridT<int16_t, 0>>("heap"  , 50*n);
+
+  return 0;
+}
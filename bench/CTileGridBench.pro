@@ -0,0 +1,28 @@
+TEMPLATE = app
+
+TARGET = CTileGridBench
+
+CONFIG -= qt
+CONFIG += console
+
+DEPENDPATH += .
+
+QMAKE_CXXFLAGS += -std=c++17
+
+# Input
+SOURCES += \
+CTileGridBench.cpp \
+../src/CTileGrid.cpp \
+
+HEADERS += \
+../include/CTileGrid.h \
+../include/CTileGridEdges.h \
+../include/CTileGridTypes.h \
+../include/CTileSmallVector.h \
+
+DESTDIR     = .
+OBJECTS_DIR = .
+
+INCLUDEPATH += \
+../include \
+.
@@ -0,0 +1,663 @@
+#include <CTileGrid.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <vector>
+
+// differential fuzzer and per operation benchmark of CTileGrid.
+// Runs random sequences of layout operations (row/column insert, fill, set cell,
+// replace, fill empty cells and duplicate removal) on grids from 2x2 to 512x512.
+// The grid and a naive reference grid get the same operations and after each
+// operation all cells and validity are compared. Set cell and replace with an
+// existing id make non-rectangular areas so the grid is also checked for layouts
+// which are not valid.
+// fillEmptyCells result is checked (unfilled grid unchanged, filled grid has no
+// empty cells and keeps all set cells) and the reference is then synced to it.
+// Grid changes are recorded and every few steps the recorded changes are undone
+// on a copy of the grid and redone on a copy of the grid from the start of the
+// recording, which must give the start and current cells.
+// Time and heap allocations are reported per operation.
+//
+// Built with -fsanitize=address,undefined (see CTileGridFuzz.pro) to also check
+// memory errors.
+//
+// usage: CTileGridFuzz [seed] [steps per grid size]
+
+//------
+
+// count heap allocations (all allocations in process go through these)
+static size_t s_numAllocs = 0;
+
+void *
+operator new(size_t n)
+{
+  ++s_numAllocs;
+
+  void *p = std::malloc(n > 0 ? n : 1);
+
+  if (! p)
+    throw std::bad_alloc();
+
+  return p;
+}
+
+void *
+operator new[](size_t n)
+{
+  return operator new(n);
+}
+
+void operator delete  (void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+
+void operator delete  (void *p, size_t) noexcept { std::free(p); }
+void operator delete[](void *p, size_t) noexcept { std::free(p); }
+
+//------
+
+namespace {
+
+// fuzzed operations
+enum class Op {
+  INSERT_ROWS,
+  INSERT_COLUMNS,
+  INSERT,
+  FILL,
+  SET_CELL,
+  REPLACE,
+  FILL_EMPTY,
+  REMOVE_DUP_ROWS,
+  REMOVE_DUP_COLS,
+  IS_VALID,
+  NUM_OPS
+};
+
+const char *opNames[] = {
+  "insertRows", "insertColumns", "insert", "fill", "setCell", "replace", "fillEmptyCells",
+  "removeDuplicateRows", "removeDuplicateCols", "isValid"
+};
+
+// time and allocations of operation
+struct OpStats {
+  long   count  { 0 };
+  double ns     { 0.0 };
+  size_t allocs { 0 };
+};
+
+using Stats = std::vector<OpStats>;
+
+using Insert  = CTileGridTypes::Insert;
+using Inserts = CTileGridTypes::Inserts;
+
+// naive reference grid (one id per cell, each operation written directly from
+// its definition)
+class RefGrid {
+ public:
+  RefGrid(int nrows, int ncols) :
+   nrows_(nrows), ncols_(ncols), cells_(uint(nrows*ncols), 0) {
+  }
+
+  int nrows() const { return nrows_; }
+  int ncols() const { return ncols_; }
+
+  int cell(int r, int c) const { return cells_[uint(r*ncols_ + c)]; }
+
+  void setCell(int r, int c, int id) { cells_[uint(r*ncols_ + c)] = id; }
+
+  void clear(int id) {
+    std::fill(cells_.begin(), cells_.end(), id);
+  }
+
+  // set size and cells from grid
+  template<typename GRID>
+  void assign(const GRID &grid) {
+    nrows_ = grid.nrows();
+    ncols_ = grid.ncols();
+
+    cells_.resize(uint(nrows_*ncols_));
+
+    for (int r = 0; r < nrows_; ++r)
+      for (int c = 0; c < ncols_; ++c)
+        setCell(r, c, grid.cell(r, c));
+  }
+
+  void fill(int r1, int c1, int r2, int c2, int id) {
+    for (int r = r1; r <= r2; ++r)
+      for (int c = c1; c <= c2; ++c)
+        setCell(r, c, id);
+  }
+
+  void replace(int oldId, int newId) {
+    for (auto &id : cells_)
+      if (id == oldId) id = newId;
+  }
+
+  // new column cells are set to the id on both sides (if same) else empty, then
+  // new row cells are set to the id above and below (if same) else empty
+  void insert(const Inserts &rowInserts, const Inserts &colInserts) {
+    std::vector<int> rowShift, colShift;
+
+    int nr = CTileGridTypes::calcShift(rowInserts, nrows_, rowShift);
+    int nc = CTileGridTypes::calcShift(colInserts, ncols_, colShift);
+
+    if (nr == 0 && nc == 0)
+      return;
+
+    if (nrows_ + nr == 0) nr = CTileGridTypes::calcShift(Inserts { Insert(0, 1) }, 0, rowShift);
+    if (ncols_ + nc == 0) nc = CTileGridTypes::calcShift(Inserts { Insert(0, 1) }, 0, colShift);
+
+    // new column number of each old column (-1 for new columns)
+    auto oldIndex = [](const std::vector<int> &shift, int n, int n2) {
+      std::vector<int> ind(uint(n2), -1);
+
+      for (int i = 0; i < n; ++i)
+        ind[uint(i + shift[uint(i)])] = i;
+
+      return ind;
+    };
+
+    int nrows2 = nrows_ + nr;
+    int ncols2 = ncols_ + nc;
+
+    std::vector<int> oldRow = oldIndex(rowShift, nrows_, nrows2);
+    std::vector<int> oldCol = oldIndex(colShift, ncols_, ncols2);
+
+    // old rows with new columns
+    std::vector<int> rows(uint(nrows_*ncols2), -1);
+
+    for (int r = 0; r < nrows_; ++r) {
+      for (int c2 = 0; c2 < ncols2; ++c2) {
+        int c = oldCol[uint(c2)];
+
+        int id = -1;
+
+        if (c >= 0)
+          id = cell(r, c);
+        else {
+          // old column after new column
+          int c3 = c2;
+
+          while (c3 < ncols2 && oldCol[uint(c3)] < 0)
+            ++c3;
+
+          int cb = (c3 < ncols2 ? oldCol[uint(c3)] : ncols_);
+
+          if (cb > 0 && cb < ncols_ && cell(r, cb - 1) == cell(r, cb))
+            id = cell(r, cb);
+        }
+
+        rows[uint(r*ncols2 + c2)] = id;
+      }
+    }
+
+    // new rows
+    std::vector<int> cells(uint(nrows2*ncols2), -1);
+
+    for (int r2 = 0; r2 < nrows2; ++r2) {
+      int r = oldRow[uint(r2)];
+
+      for (int c2 = 0; c2 < ncols2; ++c2) {
+        int id = -1;
+
+        if (r >= 0)
+          id = rows[uint(r*ncols2 + c2)];
+        else {
+          int r3 = r2;
+
+          while (r3 < nrows2 && oldRow[uint(r3)] < 0)
+            ++r3;
+
+          int rb = (r3 < nrows2 ? oldRow[uint(r3)] : nrows_);
+
+          if (rb > 0 && rb < nrows_ &&
+              rows[uint((rb - 1)*ncols2 + c2)] == rows[uint(rb*ncols2 + c2)])
+            id = rows[uint(rb*ncols2 + c2)];
+        }
+
+        cells[uint(r2*ncols2 + c2)] = id;
+      }
+    }
+
+    nrows_ = nrows2;
+    ncols_ = ncols2;
+
+    cells_.swap(cells);
+  }
+
+  // remove rows equal to previous (kept) row
+  void removeDuplicateRows() {
+    std::vector<int> cells;
+
+    int nrows = 0;
+
+    for (int r = 0; r < nrows_; ++r) {
+      if (nrows > 0 && std::equal(cells.end() - ncols_, cells.end(),
+                                  cells_.begin() + r*ncols_))
+        continue;
+
+      cells.insert(cells.end(), cells_.begin() + r*ncols_, cells_.begin() + (r + 1)*ncols_);
+
+      ++nrows;
+    }
+
+    nrows_ = nrows;
+
+    cells_.swap(cells);
+  }
+
+  // remove columns equal to previous (kept) column
+  void removeDuplicateCols() {
+    std::vector<int> keep;
+
+    for (int c = 0; c < ncols_; ++c) {
+      bool same = ! keep.empty();
+
+      for (int r = 0; same && r < nrows_; ++r)
+        same = (cell(r, c) == cell(r, keep.back()));
+
+      if (! same)
+        keep.push_back(c);
+    }
+
+    std::vector<int> cells;
+
+    for (int r = 0; r < nrows_; ++r)
+      for (int c : keep)
+        cells.push_back(cell(r, c));
+
+    ncols_ = int(keep.size());
+
+    cells_.swap(cells);
+  }
+
+  // check each id is a single filled rectangle
+  bool isValid() const {
+    struct Rect {
+      int r1 { 0 }, c1 { 0 }, r2 { -1 }, c2 { -1 };
+      int count { 0 };
+    };
+
+    std::vector<Rect> rects;
+
+    for (int r = 0; r < nrows_; ++r) {
+      for (int c = 0; c < ncols_; ++c) {
+        int id = cell(r, c);
+        if (id < 0) continue;
+
+        if (uint(id) >= rects.size())
+          rects.resize(uint(id + 1));
+
+        Rect &rect = rects[uint(id)];
+
+        if (rect.count == 0) {
+          rect.r1 = r; rect.c1 = c;
+          rect.r2 = r; rect.c2 = c;
+        }
+        else {
+          rect.r1 = std::min(rect.r1, r); rect.c1 = std::min(rect.c1, c);
+          rect.r2 = std::max(rect.r2, r); rect.c2 = std::max(rect.c2, c);
+        }
+
+        ++rect.count;
+      }
+    }
+
+    for (const auto &rect : rects)
+      if (rect.count > 0 && (rect.r2 - rect.r1 + 1)*(rect.c2 - rect.c1 + 1) != rect.count)
+        return false;
+
+    return true;
+  }
+
+ private:
+  int              nrows_ { 0 };
+  int              ncols_ { 0 };
+  std::vector<int> cells_;
+};
+
+// check grid has same size and cells as reference
+template<typename GRID>
+bool
+sameCells(const GRID &grid, const RefGrid &ref)
+{
+  if (grid.nrows() != ref.nrows() || grid.ncols() != ref.ncols())
+    return false;
+
+  for (int r = 0; r < ref.nrows(); ++r)
+    for (int c = 0; c < ref.ncols(); ++c)
+      if (grid.cell(r, c) != ref.cell(r, c))
+        return false;
+
+  return true;
+}
+
+// check fill empty cells result against cells before fill
+template<typename GRID>
+bool
+checkFillEmpty(const GRID &grid, const RefGrid &ref, bool failed)
+{
+  if (failed)
+    return sameCells(grid, ref);
+
+  if (grid.nrows() != ref.nrows() || grid.ncols() != ref.ncols())
+    return false;
+
+  for (int r = 0; r < ref.nrows(); ++r) {
+    for (int c = 0; c < ref.ncols(); ++c) {
+      int id = grid.cell(r, c);
+
+      if (id < 0 || (ref.cell(r, c) >= 0 && id != ref.cell(r, c)))
+        return false;
+    }
+  }
+
+  return true;
+}
+
+// check undo of recorded changes on copy of grid gives start cells (ref1) and redo
+// on copy of start grid (grid1) gives current cells (ref2)
+template<typename GRID>
+bool
+checkChanges(const GRID &grid1, const GRID &grid2, const CTileGridTypes::Changes &changes,
+             const RefGrid &ref1, const RefGrid &ref2)
+{
+  GRID undoGrid = grid2;
+
+  if (! CTileGridTypes::applyChanges(undoGrid, changes, true) || ! sameCells(undoGrid, ref1))
+    return false;
+
+  GRID redoGrid = grid1;
+
+  if (! CTileGridTypes::applyChanges(redoGrid, changes, false) || ! sameCells(redoGrid, ref2))
+    return false;
+
+  return (changes.empty() || changes.stamp == grid2.stamp());
+}
+
+// fuzz grids of specified initial size (tiled with areas) for number of steps
+bool
+fuzzSize(int size, int steps, unsigned seed, Stats &stats)
+{
+  std::mt19937 rng(seed);
+
+  auto rand = [&](int n) { return (n > 0 ? int(rng() % unsigned(n)) : 0); };
+
+  int maxSize = std::min(2*size, 512);
+
+  // tile initial grid with areas of (up to) 8x8 cells
+  CTileGrid grid(size, size);
+  RefGrid   ref (size, size);
+
+  grid.clear(); ref.clear(-1);
+
+  int tile = std::max(size/8, 1);
+  int id   = 1;
+
+  for (int r = 0; r < size; r += tile) {
+    for (int c = 0; c < size; c += tile, ++id) {
+      int r2 = std::min(r + tile, size) - 1;
+      int c2 = std::min(c + tile, size) - 1;
+
+      grid.fill(r, c, r2, c2, id); ref.fill(r, c, r2, c2, id);
+    }
+  }
+
+  // record changes of grid from copy of grid
+  CTileGridTypes::Changes changes;
+
+  CTileGrid grid0;
+  RefGrid   ref0(0, 0);
+
+  auto startRecord = [&]() {
+    changes.clear();
+
+    grid0 = grid; ref0 = ref;
+  };
+
+  grid.setChanges(&changes);
+
+  startRecord();
+
+  // get random id in grid (or empty)
+  auto randId = [&]() {
+    return ref.cell(rand(ref.nrows()), rand(ref.ncols()));
+  };
+
+  // get random rectangle of cells
+  auto randRect = [&](int &r1, int &c1, int &r2, int &c2) {
+    r1 = rand(ref.nrows()); r2 = std::min(r1 + rand(4), ref.nrows() - 1);
+    c1 = rand(ref.ncols()); c2 = std::min(c1 + rand(4), ref.ncols() - 1);
+  };
+
+  // get random insert positions
+  auto randInserts = [&](int n, Inserts &inserts, int &count) {
+    inserts.clear();
+
+    count = 0;
+
+    for (int i = rand(3); i >= 0 && n + count < maxSize; --i) {
+      int count1 = 1 + rand(std::min(3, maxSize - n - count));
+
+      inserts.push_back(Insert(rand(n + 3) - 1, count1));
+
+      count += count1;
+    }
+  };
+
+  // run operation on grid and add time and allocations to stats
+  auto timeOp = [&](Op op, auto fn) {
+    size_t allocs = s_numAllocs;
+
+    auto t1 = std::chrono::steady_clock::now();
+
+    fn(grid);
+
+    auto t2 = std::chrono::steady_clock::now();
+
+    OpStats &opStats = stats[uint(op)];
+
+    ++opStats.count;
+
+    opStats.ns     += std::chrono::duration<double, std::nano>(t2 - t1).count();
+    opStats.allocs += s_numAllocs - allocs;
+  };
+
+  for (int step = 0; step < steps; ++step) {
+    auto op = Op(rand(int(Op::IS_VALID)));
+
+    bool ok = true;
+
+    switch (op) {
+      case Op::INSERT_ROWS: {
+        if (ref.nrows() >= maxSize) continue;
+
+        int pos   = rand(ref.nrows() + 1);
+        int count = 1 + rand(std::min(3, maxSize - ref.nrows()));
+
+        timeOp(op, [&](auto &grid1) { grid1.insertRows(pos, count); });
+
+        ref.insert(Inserts { Insert(pos, count) }, Inserts());
+
+        break;
+      }
+      case Op::INSERT_COLUMNS: {
+        if (ref.ncols() >= maxSize) continue;
+
+        int pos   = rand(ref.ncols() + 1);
+        int count = 1 + rand(std::min(3, maxSize - ref.ncols()));
+
+        timeOp(op, [&](auto &grid1) { grid1.insertColumns(pos, count); });
+
+        ref.insert(Inserts(), Inserts { Insert(pos, count) });
+
+        break;
+      }
+      case Op::INSERT: {
+        // multiple (out of range) row and column inserts
+        Inserts rowInserts, colInserts;
+        int     nr, nc;
+
+        randInserts(ref.nrows(), rowInserts, nr);
+        randInserts(ref.ncols(), colInserts, nc);
+
+        timeOp(op, [&](auto &grid1) { grid1.insert(rowInserts, colInserts); });
+
+        ref.insert(rowInserts, colInserts);
+
+        break;
+      }
+      case Op::FILL: {
+        // fill with new, existing or empty id
+        int r1, c1, r2, c2;
+
+        randRect(r1, c1, r2, c2);
+
+        // limit number of distinct ids (for 16 bit cells)
+        if (id >= 30000) continue;
+
+        int fillId = (rand(4) ? id++ : (rand(2) ? randId() : -1));
+
+        timeOp(op, [&](auto &grid1) { ok = (grid1.fill(r1, c1, r2, c2, fillId) && ok); });
+
+        ref.fill(r1, c1, r2, c2, fillId);
+
+        break;
+      }
+      case Op::SET_CELL: {
+        // set cell to existing or empty id
+        int r = rand(ref.nrows()), c = rand(ref.ncols());
+
+        int cellId = (rand(2) ? randId() : -1);
+
+        timeOp(op, [&](auto &grid1) { ok = (grid1.setCell(r, c, cellId) && ok); });
+
+        ref.setCell(r, c, cellId);
+
+        break;
+      }
+      case Op::REPLACE: {
+        // remove, rename or merge area (or fill empty cells)
+        int oldId = randId();
+
+        if (id >= 30000) continue;
+
+        int newId = (rand(3) == 0 ? -1 : (rand(2) ? id++ : randId()));
+
+        timeOp(op, [&](auto &grid1) { ok = (grid1.replace(oldId, newId) && ok); });
+
+        ref.replace(oldId, newId);
+
+        break;
+      }
+      case Op::FILL_EMPTY: {
+        bool failed = false;
+
+        timeOp(op, [&](auto &grid1) { failed = grid1.fillEmptyCells().failed; });
+
+        ok = checkFillEmpty(grid, ref, failed);
+
+        // sync reference to grid result
+        if (ok)
+          ref.assign(grid);
+
+        break;
+      }
+      case Op::REMOVE_DUP_ROWS: {
+        timeOp(op, [&](auto &grid1) { grid1.removeDuplicateRows(); });
+
+        ref.removeDuplicateRows();
+
+        break;
+      }
+      case Op::REMOVE_DUP_COLS: {
+        timeOp(op, [&](auto &grid1) { grid1.removeDuplicateCols(); });
+
+        ref.removeDuplicateCols();
+
+        break;
+      }
+      default:
+        break;
+    }
+
+    // check grid against reference
+    bool valid1 = false;
+
+    timeOp(Op::IS_VALID, [&](auto &grid1) { valid1 = grid1.isValid(); });
+
+    const char *msg = nullptr;
+
+    bool valid = ref.isValid();
+
+    if      (! ok)
+      msg = "failed";
+    else if (! sameCells(grid, ref))
+      msg = "CTileGrid cells differ from reference";
+    else if (valid1 != valid)
+      msg = "isValid differs from reference";
+    else if (grid.rowEdges().size() != ref.nrows() || grid.colEdges().size() != ref.ncols())
+      msg = "row/column edges differ from grid size";
+    else if (step % 8 == 7) {
+      if (! checkChanges(grid0, grid, changes, ref0, ref))
+        msg = "CTileGrid undo/redo of recorded changes differs";
+
+      startRecord();
+    }
+
+    if (msg) {
+      fprintf(stderr, "%s after %s (seed %u, size %d, step %d)\n",
+              msg, opNames[int(op)], seed, size, step);
+
+      if (ref.nrows()*ref.ncols() <= 1024)
+        grid.print(std::cerr);
+
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// print stats of grid
+void
+printStats(const char *name, const Stats &stats)
+{
+  printf("%s\n", name);
+
+  for (uint i = 0; i < stats.size(); ++i) {
+    const OpStats &opStats = stats[i];
+
+    if (opStats.count == 0) continue;
+
+    printf("  %-20s %8ld ops  %12.1f ns/op  %8.2f allocs/op\n", opNames[i], opStats.count,
+           opStats.ns/double(opStats.count), double(opStats.allocs)/double(opStats.count));
+  }
+}
+
+}
+
+int
+main(int argc, char **argv)
+{
+  unsigned seed  = (argc > 1 ? unsigned(atoi(argv[1])) : 1);
+  int      steps = (argc > 2 ? atoi(argv[2]) : 2000);
+
+  printf("seed %u, %d steps per grid size\n", seed, steps);
+
+  Stats stats(uint(Op::NUM_OPS));
+
+  for (int size = 2; size <= 512; size *= 2) {
+    // fewer steps for large grids
+    int steps1 = std::max(steps/std::max(size/32, 1), 1);
+
+    if (! fuzzSize(size, steps1, seed + unsigned(size), stats))
+      return 1;
+  }
+
+  printStats("CTileGrid", stats);
+
+  return 0;
+}
@@ -0,0 +1,32 @@
+TEMPLATE = app
+
+TARGET = CTileGridFuzz
+
+CONFIG -= qt
+CONFIG += console
+
+DEPENDPATH += .
+
+QMAKE_CXXFLAGS += -std=c++17
+
+# check memory errors (timings include sanitizer overhead)
+QMAKE_CXXFLAGS += -g -fsanitize=address,undefined -fno-omit-frame-pointer
+QMAKE_LFLAGS   += -fsanitize=address,undefined
+
+# Input
+SOURCES += \
+CTileGridFuzz.cpp \
+../src/CTileGrid.cpp \
+
+HEADERS += \
+../include/CTileGrid.h \
+../include/CTileGridEdges.h \
+../include/CTileGridTypes.h \
+../include/CTileSmallVector.h \
+
+DESTDIR     = .
+OBJECTS_DIR = .
+
+INCLUDEPATH += \
+../include \
+.
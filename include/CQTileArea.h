@@ -1,11 +1,13 @@
 #ifndef CQTileArea_H
 #define CQTileArea_H
 
-#include <CTileGrid.h>
+#include <CTileLayout.h>
+#include <CTileRectIndex.h>
 
 #include <QWidget>
 #include <QPointer>
 
+#include <deque>
 #include <map>
 #include <set>
 
@@ -51,70 +53,16 @@ class CQTileArea : public QWidget {
  private:
   using Windows = std::vector<CQTileWindow *>;
 
-  //! structure to store physical placement area of area
-  struct PlacementArea {
-    int     row     { 0 };  //!< row
-    int     col     { 0 };  //!< column
-    int     nrows   { 1 };  //!< number of rows
-    int     ncols   { 1 };  //!< number of columns
-    int     areaId  { -1 }; //!< associated area (can be invalid (<= 0))
-    Windows windows;        //!< associated area windows (used for saving)
-    int     x       { 0 };  //!< x
-    int     y       { 0 };  //!< y
-    int     width   { 1 };  //!< width
-    int     height  { 1 };  //!< height
-
-    int row1() const { return row        ; }
-    int col1() const { return col        ; }
-    int row2() const { return row + nrows; }
-    int col2() const { return col + ncols; }
-
-    int x1() const { return x         ; }
-    int y1() const { return y         ; }
-    int x2() const { return x + width ; }
-    int y2() const { return y + height; }
-
-    int xm() const { return x + width /2; }
-    int ym() const { return y + height/2; }
-
-    void place(int r, int c, int nr, int nc, int id) {
-      row    = r;
-      col    = c;
-      nrows  = nr;
-      ncols  = nc;
-      areaId = id;
-      x      = col*100;
-      y      = row*100;
-      width  = 100*nc;
-      height = 100*nr;
-    }
-
-    QRect rect() const { return QRect(x, y, width, height); }
-  };
-
-  using AreaSet = std::set<int>;
-
-  //! structure to store horizontal splitter geometry
-  struct HSplitter {
-    int      col1 { -1 };       //!< min col extend of splitter (needed ?)
-    int      col2 { -1 };       //!< max col extend of splitter (needed ?)
-    AreaSet  tareas;            //!< areas above splitter
-    AreaSet  bareas;            //!< areas below splitter
-    int      splitterId { -1 }; //!< splitter widget id
-
-    HSplitter() { }
-  };
-
-  //! structure to store vertical splitter geometry
-  struct VSplitter {
-    int      row1 { -1 };       //!< min row extend of splitter (needed ?)
-    int      row2 { -1 };       //!< max row extend of splitter (needed ?)
-    AreaSet  lareas;            //!< areas left of splitter
-    AreaSet  rareas;            //!< areas right of splitter
-    int      splitterId { -1 }; //!< splitter widget id
-
-    VSplitter() { }
-  };
+  using Grid              = CTileLayout::Grid;
+  using PlacementArea     = CTileLayout::PlacementArea;
+  using AreaSet           = CTileLayout::AreaSet;
+  using HSplitter         = CTileLayout::HSplitter;
+  using VSplitter         = CTileLayout::VSplitter;
+  using PlacementAreas    = CTileLayout::PlacementAreas;
+  using HSplitterArray    = CTileLayout::HSplitterArray;
+  using RowHSplitterArray = CTileLayout::RowHSplitterArray;
+  using VSplitterArray    = CTileLayout::VSplitterArray;
+  using ColVSplitterArray = CTileLayout::ColVSplitterArray;
 
   //! current highlight
   struct Highlight {
@@ -128,12 +76,16 @@ class CQTileArea : public QWidget {
     }
   };
 
+  //! cached size hints of window area
+  struct AreaSizeHints {
+    QSize minSize;  //!< minimum size hint
+    QSize prefSize; //!< preferred size hint
+    QSize maxSize;  //!< maximum size
+  };
+
   using WindowAreas       = std::map<int, CQTileWindowArea *>;
-  using PlacementAreas    = std::vector<PlacementArea>;
-  using HSplitterArray    = std::vector<HSplitter>;
-  using RowHSplitterArray = std::map<int, HSplitterArray>;
-  using VSplitterArray    = std::vector<VSplitter>;
-  using ColVSplitterArray = std::map<int, VSplitterArray>;
+  using AreaSizeHintsMap  = std::map<int, AreaSizeHints>;
+  using AreaWindows       = std::vector<Windows>;
   using SplitterInd       = std::pair<int, int>;
 
  public:
@@ -141,10 +93,11 @@ class CQTileArea : public QWidget {
   struct PlacementState {
     bool              valid_     { false }; //!< is valid
     bool              transient_ { true };  //!< is transient state
-    CTileGrid         grid_;                //!< saved grid
+    Grid              grid_;                //!< saved grid
     PlacementAreas    placementAreas_;      //!< saved placement areas
     RowHSplitterArray hsplitters_;          //!< saved hsplitters
     ColVSplitterArray vsplitters_;          //!< saved vsplitter
+    AreaWindows       areaWindows_;         //!< saved placement area windows (if not transient)
 
     PlacementState() {
       reset();
@@ -156,6 +109,27 @@ class CQTileArea : public QWidget {
     }
   };
 
+ private:
+  //! layout change (undo/redo step).
+  //! Only the grid changes recorded during the step (changed cells and inserted or
+  //! removed rows/columns, see Grid::setChanges) and the row/column edges (if changed)
+  //! are stored. Placement areas and splitters are rebuilt from the grid when the
+  //! change is applied.
+  struct LayoutDelta {
+    uint64_t       stamp1       { 0 };     //!< old grid stamp
+    uint64_t       stamp2       { 0 };     //!< new grid stamp
+    Grid::Changes  changes;                //!< grid changes
+    bool           edgesChanged { false }; //!< row/column edges changed
+    CTileGridEdges rowEdges1;              //!< old row edges (if changed)
+    CTileGridEdges colEdges1;              //!< old column edges (if changed)
+    CTileGridEdges rowEdges2;              //!< new row edges (if changed)
+    CTileGridEdges colEdges2;              //!< new column edges (if changed)
+
+    bool isEmpty() const { return (changes.empty() && ! edgesChanged); }
+  };
+
+  using LayoutDeltas = std::deque<LayoutDelta>;
+
  public:
   //! create tile area
   CQTileArea(QMainWindow *window);
@@ -164,17 +138,21 @@ class CQTileArea : public QWidget {
  ~CQTileArea();
 
   //! get/set border
-  int  border() const { return border_; }
-  void setBorder(int border) { border_ = border; }
+  int  border() const { return layout_.border(); }
+  void setBorder(int border) { layout_.setBorder(border); }
 
   //! get/set splitter size
-  int  splitterSize() const { return splitterSize_; }
-  void setSplitterSize(int size) { splitterSize_ = size; }
+  int  splitterSize() const { return layout_.splitterSize(); }
+  void setSplitterSize(int size) { layout_.setSplitterSize(size); }
 
   //! get/set drag animation enabled
   bool animateDrag() const { return animateDrag_; }
   void setAnimateDrag(bool animate) { animateDrag_ = animate; }
 
+  //! get/set splitters drawn by area (no splitter widgets)
+  bool paintSplitters() const { return paintSplitters_; }
+  void setPaintSplitters(bool paint);
+
   //! get/set title active color
   QColor titleActiveColor   () const { return titleActiveColor_; }
   void   setTitleActiveColor(const QColor &color);
@@ -191,6 +169,15 @@ class CQTileArea : public QWidget {
   //! remove window
   void removeWindow(CQTileWindow *window);
 
+  //! start layout change (placement and title updates of window adds, removes and
+  //! moves are deferred until outermost end, may be nested)
+  void beginLayoutChange();
+  //! end layout change (deferred updates are applied in a single pass)
+  void endLayoutChange();
+
+  //! is layout change in progress
+  bool isLayoutChange() const { return layoutDepth_ > 0; }
+
   //! get current window
   CQTileWindow *currentWindow() const;
 
@@ -215,6 +202,17 @@ class CQTileArea : public QWidget {
   //! set layout to specified grid (for testing)
   void setGrid(int nrows, int ncols, const std::vector<int> &cells);
 
+  //! can undo/redo last layout change
+  bool canUndo() const { return ! undoDeltas_.empty(); }
+  bool canRedo() const { return ! redoDeltas_.empty(); }
+
+  //! undo/redo last layout change (returns false if no longer applicable)
+  bool undo();
+  bool redo();
+
+  //! clear undo/redo history
+  void clearUndo();
+
  private:
   friend class CQTileWindowArea;
   friend class CQTileWindowTabBar;
@@ -266,32 +264,50 @@ class CQTileArea : public QWidget {
   //! update placement from grid
   void gridToPlacement(bool useExisting=true);
 
-  //! add splitters between cells
-  void addSplitters();
-
-  //! combine splitters
-  void combineTouchingSplitters();
+  //! assign splitter widgets to layout splitters
+  void addSplitterWidgets();
 
   //! update all placement geometries
   void updatePlacementGeometries();
-  //! update specified placement geometry
+  //! update placement geometries of placement areas at indices
+  void updatePlacementGeometries(const std::vector<int> &pids);
+  //! update specified placement geometry (in geometry update)
   void updatePlacementGeometry(PlacementArea &placementArea);
-
-  //! check for intersect or vertical and horizontal splitters
-  void intersectVSplitter(int row, const HSplitter &hsplitter);
-
-  //! add horizontal splitter at specified row (above or below specified placement)
-  void addHSplitter(int i, int row, bool top);
-  //! add vertical splitter at specified column (left or right of specified placement)
-  void addVSplitter(int i, int col, bool left);
+  //! update placement area rectangle in placement index
+  void updatePlacementIndex(int pid);
+
+  //! update all splitter rectangles (deferred to end of geometry update)
+  void updateSplitterGeometries();
+  //! update rectangles of splitters next to placement areas at indices (deferred to
+  //! end of geometry update)
+  void updateSplitterGeometries(const std::vector<int> &pids);
+  //! update splitter rectangles deferred by geometry update
+  void updatePendingSplitters();
+  //! update cached rectangle (and widget geometry) of splitter from its layout splitter
+  void updateSplitterGeometry(int i);
+
+  //! update splitter list from layout splitters and splitters next to each placement area
+  void updateAreaSplitters();
+
+  //! start geometry update (if repaint then area widget updates are disabled until
+  //! matching end and area is repainted once, else only changed widgets repaint)
+  void beginGeometryUpdate(bool repaint=true);
+  //! end geometry update (shows reparented areas, moves splitters and repaints once)
+  void endGeometryUpdate();
 
   //! adjust sizes of cells to fit geometry
   void adjustToFit();
 
-  //! adjust placements which must have same width to match splitters
-  void adjustSameWidthPlacements (PlacementArea &area);
-  //! adjust placements which must have same height to match splitters
-  void adjustSameHeightPlacements(PlacementArea &area);
+  //! update layout size and area minimum sizes from widgets
+  void updateLayoutSizes();
+
+  //! get layout size constraints of window area
+  CTileLayout::AreaSize getLayoutAreaSize(CQTileWindowArea *area) const;
+
+  //! get (cached) size hints of window area
+  const AreaSizeHints &getAreaSizeHints(CQTileWindowArea *area) const;
+  //! invalidate cached size hints of window area
+  void invalidateAreaSizeHints(CQTileWindowArea *area);
 
   //! update titles
   void updateTitles();
@@ -301,17 +317,10 @@ class CQTileArea : public QWidget {
 
   //! get placement area index from id
   int getPlacementAreaIndex(int id) const;
-  //! get placement area index from id from list of placements
-  int getPlacementAreaIndex(const PlacementAreas &area, int id) const;
 
   //! get area at specified row/col
   CQTileWindowArea *getAreaAt(int row, int col) const;
 
-  //! get horizontal splitter at specified row and column range
-  bool getHSplitter(int row, int col1, int col2, int &is);
-  //! get vertical splitter at specified column and row range
-  bool getVSplitter(int col, int row1, int row2, int &is);
-
   //! get horizontal splitter rectangle
   QRect getHSplitterRect(const HSplitter &splitter) const;
   //! get vertical splitter rectangle
@@ -332,13 +341,32 @@ class CQTileArea : public QWidget {
   //! handle resize event
   void resizeEvent(QResizeEvent *) override;
 
-  //! handle paint event
+  //! handle paint event (draws splitters if painted by area)
   void paintEvent(QPaintEvent *) override;
 
-  //! move horizontal splitter
-  void moveHSplitter(int row, int ind, int dy);
-  //! move vertical splitter
-  void moveVSplitter(int col, int ind, int dx);
+  //! handle mouse events (hover and drag of splitters painted by area)
+  void mousePressEvent  (QMouseEvent *e) override;
+  void mouseMoveEvent   (QMouseEvent *e) override;
+  void mouseReleaseEvent(QMouseEvent *e) override;
+
+  //! handle leave event (clear splitter hover)
+  void leaveEvent(QEvent *e) override;
+
+  //! set splitter under mouse (updates cursor and hover highlight)
+  void setHoverSplitter(int i);
+
+  //! handle window area layout request (size hints changed)
+  bool eventFilter(QObject *obj, QEvent *e) override;
+
+  //! start drag of splitter (drags all splitters on row/column edge)
+  bool beginSplitterDrag(Qt::Orientation orient, int pos);
+  //! move dragged splitter to offset from drag start
+  void dragSplitter(int d);
+  //! end splitter drag
+  void endSplitterDrag();
+
+  //! end drag (and undo step) of painted splitter if in progress
+  void endSplitterMouseDrag();
 
   int createSplitterWidget(Qt::Orientation orient, int pos, int ind);
 
@@ -356,6 +384,9 @@ class CQTileArea : public QWidget {
 
   //! get highlight for specified point
   void setHighlight(const QPoint &pos);
+  //! get squared distance of point to nearest side and center of placement area
+  void highlightDist(const PlacementArea &placementArea, int px, int py,
+                     int &d, Side &side, int &dm) const;
   //! clear highlight
   void clearHighlight();
 
@@ -368,8 +399,41 @@ class CQTileArea : public QWidget {
   //! restore state
   void restoreState(const PlacementState &state);
 
+  //! set layout (grid, placement and splitters) from state without updating widgets
+  void setLayoutState(const PlacementState &state);
+
+  //! apply (fitted transient) state to widgets without resolving sizes
+  void applyLayoutState(const PlacementState &state);
+
+  //! start/end recording layout change for undo (may be nested)
+  void beginUndoStep();
+  void endUndoStep();
+
+  //! apply old (undo) or new (redo) side of layout change (layout is unchanged if it
+  //! does not apply to the current grid)
+  bool applyLayoutDelta(const LayoutDelta &delta, bool undo);
+
+  //! update splitter widgets from splitters
+  void updateSplitterWidgets();
+
   //! set default placement size (size of empty cell)
-  void setDefPlacementSize(int w, int h);
+  void setDefPlacementSize(int w, int h) { layout_.setDefPlacementSize(w, h); }
+
+  //! get layout grid
+  Grid       &grid()       { return layout_.grid(); }
+  const Grid &grid() const { return layout_.grid(); }
+
+  //! get layout placement areas
+  PlacementAreas       &placementAreas()       { return layout_.placementAreas(); }
+  const PlacementAreas &placementAreas() const { return layout_.placementAreas(); }
+
+  //! get layout horizontal splitters
+  RowHSplitterArray       &hsplitters()       { return layout_.hsplitters(); }
+  const RowHSplitterArray &hsplitters() const { return layout_.hsplitters(); }
+
+  //! get layout vertical splitters
+  ColVSplitterArray       &vsplitters()       { return layout_.vsplitters(); }
+  const ColVSplitterArray &vsplitters() const { return layout_.vsplitters(); }
 
   //! get area for placement area id
   CQTileWindowArea *getAreaForId(int areaId) const;
@@ -393,6 +457,10 @@ class CQTileArea : public QWidget {
   void restoreSlot();
   //! tile all windows
   void tileSlot();
+  //! undo last layout change
+  void undoSlot();
+  //! redo last undone layout change
+  void redoSlot();
   //! detach current window
   void detachSlot();
   //! close current window
@@ -409,6 +477,10 @@ class CQTileArea : public QWidget {
   //! adjust sizes (debug)
   void adjustSlot();
 
+ private Q_SLOTS:
+  //! refit layout for changed area size hints (queued by layout requests)
+  void refitSlot();
+
  signals:
   //! current window changed signal
   void currentWindowChanged(CQTileWindow *);
@@ -419,29 +491,67 @@ class CQTileArea : public QWidget {
  private:
   using MenuIconP       = QPointer<CQTileAreaMenuIcon> ;
   using MenuControlsP   = QPointer<CQTileAreaMenuControls>;
+  using WindowAreaPs    = std::vector<QPointer<CQTileWindowArea>>;
+  using SplitterIds     = CTileSmallVector<int, 4>;
+  using AreaSplitters   = std::vector<SplitterIds>;
+
+  //! splitter key and cached rectangle
+  struct SplitterRect {
+    Qt::Orientation orient   { Qt::Vertical }; //!< orientation
+    int             pos      { -1 };           //!< row/column
+    int             ind      { -1 };           //!< index in row/column splitters
+    int             widgetId { -1 };           //!< splitter widget id (-1 if painted)
+    QRect           rect;                      //!< rectangle
+  };
+
+  using SplitterRects = std::vector<SplitterRect>;
+
+  //! mouse state of splitters painted by area
+  struct SplitterMouseState {
+    int    hover    { -1 };    //!< splitter under mouse
+    int    pressed  { -1 };    //!< pressed (dragged) splitter
+    bool   dragging { false }; //!< splitter drag (and its undo step) in progress
+    QPoint pressPos;           //!< mouse press position
+  };
   using SplitterWidgets = std::map<int, CQTileAreaSplitter *>;
 
   QMainWindow*       window_             { nullptr }; //!< parent window
-  CTileGrid          grid_;                           //!< layout grid
+  CTileLayout        layout_;                         //!< layout (grid, placement and splitters)
   bool               animateDrag_        { true};     //!< animate drag
   QColor             titleActiveColor_;               //!< title active color
   QColor             titleInactiveColor_;             //!< title inactive color
   WindowAreas        areas_;                          //!< window areas
-  PlacementAreas     placementAreas_;                 //!< placed areas
-  RowHSplitterArray  hsplitters_;                     //!< horizontal splitters
-  ColVSplitterArray  vsplitters_;                     //!< vertical splitters
   SplitterWidgets    splitterWidgets_;                //!< splitter widgets
+  bool               paintSplitters_     { false };   //!< splitters drawn by area
+  SplitterRects      splitterRects_;                  //!< splitter keys and rectangles
+  CTileRectIndex     splitterIndex_;                  //!< splitter rectangle index (hit test)
+  CTileRectIndex     placementIndex_;                 //!< placement area index (drop target)
+  AreaSplitters      areaSplitters_;                  //!< splitters of each placement area
+  SplitterMouseState splitterMouse_;                  //!< painted splitter mouse state
   Highlight          highlight_;                      //!< current highlight (for drag)
   PlacementState     restoreState_;                   //!< saved state to restore from maximized
-  int                border_             { 0 };       //!< border
-  int                splitterSize_       { 3 };       //!< splitter size
   CQRubberBand*      rubberBand_         { nullptr }; //!< rubber band (for drag)
   CQTileWindowArea*  currentArea_        { nullptr }; //!< current window area
   bool               hasControls_        { false };   //!< has menu controls
   MenuIconP          menuIcon_;                       //!< menu bar icon button
   MenuControlsP      menuControls_;                   //!< menu bar controls
-  int                defWidth_           { -1 };      //!< default (new) area width
-  int                defHeight_          { -1 };      //!< default (new) area height
+  LayoutDeltas       undoDeltas_;                     //!< undo history (oldest first)
+  LayoutDeltas       redoDeltas_;                     //!< redo history (oldest first)
+  LayoutDelta        undoDelta_;                      //!< layout change of current undo step
+  int                undoDepth_          { 0 };       //!< undo step nesting depth
+  std::vector<int>   changedAreas_;                   //!< placement areas changed by resize/move
+  mutable AreaSizeHintsMap areaSizeHints_;            //!< cached window area size hints
+  int                layoutDepth_        { 0 };       //!< layout change nesting depth
+  bool               placementPending_   { false };   //!< placement update deferred
+  bool               placementExisting_  { true };    //!< deferred placement uses existing sizes
+  bool               titlesPending_      { false };   //!< title update deferred
+  bool               refitPending_       { false };   //!< refit for layout requests queued
+  std::vector<int>   refitAreas_;                     //!< areas with changed size hints to refit
+  int                geometryDepth_      { 0 };       //!< geometry update nesting depth
+  bool               geometryUpdates_    { false };   //!< updates disabled by geometry update
+  WindowAreaPs       showAreas_;                      //!< reparented areas to show at update end
+  bool               splittersPending_   { false };   //!< all splitters updated at update end
+  std::vector<int>   pendingSplitters_;               //!< splitters updated at update end
 };
 
 #endif
@@ -6,6 +6,7 @@ namespace CQTileAreaConstants {
   static const int             min_size        = 16;
   static const int             highlight_size  = 16;
   static const int             attach_timeout  = 10;
+  static const int             max_undo        = 256;
   static const QColor          bar_active_fg   = QColor(140, 140, 140);
   static const QColor          bar_inactive_fg = QColor(120, 120, 120);
   static const Qt::WindowFlags normalFlags     = Qt::Widget;
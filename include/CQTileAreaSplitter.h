@@ -16,7 +16,12 @@ class CQTileAreaSplitter : public QWidget {
   //! set orientation and splitter key
   void init(Qt::Orientation orient, int pos, int ind);
 
-  //! get/set used
+  //! get orientation and splitter key (row/column and index)
+  Qt::Orientation orient() const { return orient_; }
+  int             pos   () const { return pos_; }
+  int             ind   () const { return ind_; }
+
+  //! get/set used (unused splitter ends its drag)
   bool used() const { return used_; }
   void setUsed(bool used);
 
@@ -33,6 +38,12 @@ class CQTileAreaSplitter : public QWidget {
   //! handle paint
   void paintEvent(QPaintEvent *) override;
 
+  //! handle hide (ends drag)
+  void hideEvent(QHideEvent *) override;
+
+  //! end drag (and its undo step) if in progress
+  void endDrag();
+
  private:
   //! structure for mouse state
   struct MouseState {
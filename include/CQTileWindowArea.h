@@ -5,6 +5,8 @@
 
 #include <QFrame>
 
+#include <tuple>
+
 class CQTileWindow;
 
 //! class for each window area
@@ -142,6 +144,10 @@ class CQTileWindowArea : public QFrame {
 
   static int lastId_; //! last area index (incremented on use for unique id)
 
+  //! drop target (side, start row, start column, end row, end column)
+  using PreviewKey    = std::tuple<int, int, int, int, int>;
+  using PreviewStates = std::map<PreviewKey, PlacementState>;
+
   struct AttachData {
     QTimer           *timer;      //! attach timer;
     PlacementState    initState;  //! saved (original) state
@@ -153,10 +159,13 @@ class CQTileWindowArea : public QFrame {
     int               col1;       //! attach start column
     int               row2;       //! attach end row
     int               col2;       //! attach end column
+    PreviewStates     previews;   //! cached preview states for drop targets
+    QSize             areaSize;   //! area size of cached preview states
 
     AttachData() :
      timer(nullptr), initState(), state(), initDocked(true),
-     rect(), side(CQTileArea::NO_SIDE), row1(0), col1(0), row2(0), col2(0) {
+     rect(), side(CQTileArea::NO_SIDE), row1(0), col1(0), row2(0), col2(0),
+     previews(), areaSize() {
     }
   };
 
@@ -0,0 +1,99 @@
+#ifndef CTileConstraintSolver_H
+#define CTileConstraintSolver_H
+
+#include <sys/types.h>
+#include <vector>
+
+//! solver for positions along one axis (e.g. splitter positions) with linear
+//! difference constraints:
+//!   minimum distance : pos[j] - pos[i] >= d
+//!   maximum distance : pos[j] - pos[i] <= d
+//!   fixed position   : pos[i] == p
+//!
+//! The lower/upper bound of each position is propagated over the constraint graph
+//! (longest/shortest paths) and the variables are then set, in order, to their
+//! preferred position clamped to the current bounds, so there is one deterministic
+//! answer for the same input. If the constraints can not all be met the maximum
+//! distances are dropped and then weak fixed positions become minimum positions.
+class CTileConstraintSolver {
+ public:
+  CTileConstraintSolver() { }
+
+  //! remove all variables and constraints
+  void clear();
+
+  //! get number of variables
+  int numVariables() const { return int(vars_.size()); }
+
+  //! add variable with preferred position (returns variable index)
+  int addVariable(int pref=0);
+
+  //! set preferred position of variable
+  void setPreferred(int i, int pref) { vars_[uint(i)].pref = pref; }
+
+  //! fix position of variable (a weak fixed position can increase if needed)
+  void setFixed(int i, int pos, bool weak=false);
+
+  //! add minimum distance from variable i to variable j
+  void addMinDistance(int i, int j, int d);
+  //! add maximum distance from variable i to variable j
+  void addMaxDistance(int i, int j, int d);
+
+  //! solve positions (returns false if constraints were relaxed)
+  bool solve();
+
+  //! get solved position of variable
+  int pos(int i) const { return vars_[uint(i)].pos; }
+
+ private:
+  //! variable
+  struct Variable {
+    int  pref     { 0 };     //!< preferred position
+    bool fixed    { false }; //!< is fixed
+    bool weak     { false }; //!< fixed position is weak
+    int  fixedPos { 0 };     //!< fixed position
+    int  pos      { 0 };     //!< solved position
+  };
+
+  //! constraint pos[j] - pos[i] >= d (maximum distances are stored reversed)
+  struct Constraint {
+    int  i        { 0 };
+    int  j        { 0 };
+    int  d        { 0 };
+    bool optional { false }; //!< can be dropped (maximum distance)
+  };
+
+  using Variables   = std::vector<Variable>;
+  using Constraints = std::vector<Constraint>;
+  using Indices     = std::vector<int>;
+  using VarIndices  = std::vector<Indices>;
+  using Flags       = std::vector<bool>;
+
+  //! relaxation stage
+  enum class Stage {
+    ALL,         //!< all constraints
+    NO_OPTIONAL, //!< without optional constraints
+    NO_WEAK      //!< without optional constraints and weak fixed positions
+  };
+
+ private:
+  //! solve for relaxation stage (returns false if constraints can not be met)
+  bool solveStage(Stage stage);
+
+  //! propagate bounds from variables in work list (returns false if inconsistent)
+  bool propagate(Stage stage);
+
+  //! add variable to propagation work list
+  void addWork(int i);
+
+ private:
+  Variables   vars_;        //!< variables
+  Constraints constraints_; //!< constraints
+  VarIndices  varCons_;     //!< constraint indices for each variable
+  Indices     lo_;          //!< current lower bounds
+  Indices     hi_;          //!< current upper bounds
+  Indices     work_;        //!< propagation work list
+  Flags       inWork_;      //!< variable is in work list
+};
+
+#endif
@@ -1,19 +1,58 @@
 #ifndef CTileGrid_H
 #define CTileGrid_H
 
+#include <CTileGridEdges.h>
+#include <CTileGridTypes.h>
+#include <CTileSmallVector.h>
 #include <vector>
 #include <iostream>
+#include <cstdint>
 
 // grid with rows x cols cells where each cells has an associated area
 // number to represent which window area is contained in it.
 // Multiple cells may have same window area to support multiple cell spanning
 // TODO: add unique x/y values and reconfigure grid to match (i.e. new x/y values
 // are added removed)
-// TODO: store real offsets of edges for smooth resize
-class CTileGrid {
+// The fractional position of each row and column edge is stored with the cells
+// (see CTileGridEdges) so the relative size of each row and column is kept when
+// rows and columns are inserted or removed.
+// Each row and column keeps a hash of its cells (sum of cell hashes keyed by
+// a per row/column token) which is updated on every cell change so duplicate
+// rows/columns can be found without comparing all cells.
+// An index of the bounding box and cell count of each id is also maintained so
+// area extents and grid validity can be checked without walking the cells.
+// Cells are stored as CELL values (int16_t or int32_t). Empty cells (-1) are
+// stored as -1 and other ids are remapped to dense values (0, 1, ...) so the
+// number of distinct ids in the grid is limited by the CELL type, not the ids.
+// Operations which would add an id to a grid with no free cell values fail
+// (return false) and leave the grid unchanged.
+// Grids with up to N cells (and N rows, columns and ids) keep all their data
+// inline so copying or creating a small grid does not allocate.
+// Each change of cells or rows/columns gives the grid a new stamp (copies keep it)
+// and can be recorded (see setChanges) so it can be undone or redone later.
+template<typename CELL, int N=16>
+class CTileGridT {
+ public:
+  typedef CTileGridTypes::FillResult  FillResult;
+  typedef CTileGridTypes::Insert      Insert;
+  typedef CTileGridTypes::Inserts     Inserts;
+  typedef CTileGridTypes::AreaRegion  AreaRegion;
+  typedef CTileGridTypes::AreaRegions AreaRegions;
+  typedef CTileGridTypes::Change      Change;
+  typedef CTileGridTypes::Changes     Changes;
+
+ public:
+  typedef CELL Cell;
+
+  //! inline capacity (number of cells stored without heap allocation)
+  static constexpr int inlineCells() { return N; }
+
+  //! get cell index for row/column
+  static constexpr int cellIndex(int r, int c, int ncols) { return r*ncols + c; }
+
  public:
   //! create grid
-  CTileGrid(int nrows=0, int ncols=0) :
+  CTileGridT(int nrows=0, int ncols=0) :
    nrows_(0), ncols_(0) {
     setSize(nrows, ncols);
   }
@@ -22,102 +61,354 @@ class CTileGrid {
   int nrows() const { return nrows_; }
   int ncols() const { return ncols_; }
 
-  //! get editable cell at row/column
-  int &cell(int r, int c) {
-    return cells_[uint(r*ncols_ + c)];
-  }
-
   //! get cell at row/column
   int cell(int r, int c) const {
-    return cells_[uint(r*ncols_ + c)];
+    return valueId(cells_[uint(cellIndex(r, c, ncols_))]);
   }
 
   //! get cell at index
   int cell(int ind) const {
-    return cells_[uint(ind)];
+    return valueId(cells_[uint(ind)]);
+  }
+
+  //! set cell at row/column (false if id can't be added)
+  bool setCell(int r, int c, int id) {
+    int v = idValue(id);
+
+    if (v < -1)
+      return false;
+
+    int ind = cellIndex(r, c, ncols_);
+
+    if (cells_[uint(ind)] == v)
+      return true;
+
+    if (record_.changes)
+      record_.changes->addCell(ind, cell(ind), id);
+
+    setValue(r, c, v);
+
+    changed();
+
+    return true;
   }
 
   //! reset to empty
   void reset() {
+    Change *change = beginResize();
+
     nrows_ = 0;
     ncols_ = 0;
 
     cells_.clear();
+
+    rowEdges_.reset(0);
+    colEdges_.reset(0);
+
+    rehash();
+    reindex();
+
+    endResize(change);
   }
 
   //! set size
   void setSize(int nrows, int ncols) {
+    Change *change = beginResize();
+
     nrows_ = nrows;
     ncols_ = ncols;
 
-    cells_.resize(uint(nrows_*ncols_));
+    // new cells are set to id 0 (empty if id can't be added)
+    int v = idValue(0);
+
+    cells_.resize(uint(nrows_*ncols_), Cell(v >= -1 ? v : -1));
+
+    rowEdges_.reset(nrows_);
+    colEdges_.reset(ncols_);
+
+    rehash();
+    reindex();
+
+    endResize(change);
   }
 
+  //! get content stamp (new stamp for every change)
+  uint64_t stamp() const { return stamp_; }
+
+  //! set content stamp (for grid with same cells as grid with stamp)
+  void setStamp(uint64_t stamp) { stamp_ = stamp; }
+
+  //! set changes to record grid changes to (nullptr to stop recording)
+  void setChanges(Changes *changes) { record_.changes = changes; }
+
+  //! get row edge positions (nrows + 1 edges)
+  const CTileGridEdges &rowEdges() const { return rowEdges_; }
+  CTileGridEdges &rowEdges() { return rowEdges_; }
+
+  //! get column edge positions (ncols + 1 edges)
+  const CTileGridEdges &colEdges() const { return colEdges_; }
+  CTileGridEdges &colEdges() { return colEdges_; }
+
   //! is single cell
   bool isSingleCell() const { return cells_.size() == 1; }
 
-  //! replace old index with new index
-  void replace(int oldId, int newId) {
-    uint n = uint(nrows_*ncols_);
+  //! are cells stored inline (no heap allocation)
+  bool isInline() const { return ! cells_.isHeap(); }
 
-    for (uint i = 0; i < n; ++i) {
-      if (cells_[i] == oldId)
-        cells_[i] = newId;
-    }
-  }
+  //! replace old index with new index (false if new id can't be added)
+  bool replace(int oldId, int newId);
 
   //! clear to index
-  void clear(int ind=-1) {
-    uint n = uint(nrows_*ncols_);
+  void clear(int ind=-1);
 
-    for (uint i = 0; i < n; ++i)
-      cells_[i] = ind;
-  }
-
-  //! fill range with index
-  void fill(int r1, int c1, int r2, int c2, int id) {
-    for (int r = r1; r <= r2; ++r)
-      for (int c = c1; c <= c2; ++c)
-        cell(r, c) = id;
-  }
+  //! fill range with index (false if id can't be added)
+  bool fill(int r1, int c1, int r2, int c2, int id);
 
   //! insert specified number of rows at row
   void insertRows   (int row, int nrows);
   //! insert specified number of columns at column
   void insertColumns(int col, int ncols);
 
+  //! insert multiple rows and columns in one pass
+  void insert(const Inserts &rowInserts, const Inserts &colInserts);
+
   //! is valid
   bool isValid() const;
 
   //! expand occupied cells to fill empty ones
-  bool fillEmptyCells();
-
-  //! fill columns to left of column and row range
-  bool fillLeft  (int c, int r1, int r2);
-  //! fill columns to right of column and row range
-  bool fillRight (int c, int r1, int r2);
-  //! fill columns above row and column range
-  bool fillTop   (int c, int r1, int r2);
-  //! fill columns below row and column range
-  bool fillBottom(int c, int r1, int r2);
+  FillResult fillEmptyCells();
 
   //! remove duplicate rows
   void removeDuplicateRows();
   //! remove duplicate columns
   void removeDuplicateCols();
 
+  //! remove rows with removed flag set (removed row merges with row above)
+  void removeRows(const std::vector<bool> &removed);
+  //! remove columns with removed flag set (removed column merges with column to left)
+  void removeCols(const std::vector<bool> &removed);
+
   //! get region for specified id
-  bool getRegion(int id, int r1, int c1, int *nr, int *nc);
+  bool getRegion(int id, int r1, int c1, int *nr, int *nc) const;
+
+  //! get rectangular regions of all ids (ordered by start row and column)
+  void getAreaRegions(AreaRegions &regions) const;
 
   //! print grid
   void print(std::ostream &os);
 
  private:
-  typedef std::vector<int> Cells;
+  //! cell rectangle (inclusive)
+  struct Region {
+    int r1 { 0 }; //!< start row
+    int c1 { 0 }; //!< start column
+    int r2 { 0 }; //!< end row
+    int c2 { 0 }; //!< end column
+
+    Region() { }
+
+    Region(int r1, int c1, int r2, int c2) :
+     r1(r1), c1(c1), r2(r2), c2(c2) {
+    }
+
+    int nrows() const { return r2 - r1 + 1; }
+    int ncols() const { return c2 - c1 + 1; }
+
+    //! check if touching (or overlapping) other region (including corners)
+    bool touches(const Region &region) const {
+      return (region.r1 <= r2 + 1 && region.r2 >= r1 - 1 &&
+              region.c1 <= c2 + 1 && region.c2 >= c1 - 1);
+    }
+  };
+
+  //! changed cell (index and old value) for rollback
+  typedef std::pair<uint, int>      JournalEntry;
+  typedef std::vector<JournalEntry> Journal;
+
+  //! fill empty region from cells on side (0=left, 1=right, 2=top, 3=bottom)
+  bool fillSide(const Region &region, int side, Journal &journal);
+
+  //! set new stamp after change
+  void changed() {
+    stamp_ = CTileGridTypes::newStamp();
+
+    if (record_.changes)
+      record_.changes->stamp = stamp_;
+  }
+
+  //! start recording resize (old size and cells), returns nullptr if not recording
+  Change *beginResize() {
+    if (! record_.changes)
+      return nullptr;
+
+    Change &change = record_.changes->add(Change::Type::RESIZE);
 
-  Cells cells_; //! grid cells
-  int   nrows_; //! number of rows
-  int   ncols_; //! number of columns
+    change.nrows1 = nrows_;
+    change.ncols1 = ncols_;
+
+    getIds(change.ids1);
+
+    return &change;
+  }
+
+  //! end recording resize (new size and cells)
+  void endResize(Change *change) {
+    if (change) {
+      change->nrows2 = nrows_;
+      change->ncols2 = ncols_;
+
+      getIds(change->ids2);
+    }
+
+    changed();
+  }
+
+  //! get ids of all cells
+  void getIds(std::vector<int> &ids) const {
+    ids.resize(cells_.size());
+
+    for (uint i = 0; i < cells_.size(); ++i)
+      ids[i] = valueId(cells_[i]);
+  }
+
+  //! get id for cell value
+  int valueId(int v) const { return (v < 0 ? v : ids_[uint(v)]); }
+
+  //! get cell value for id (-2 if not in grid)
+  int findValue(int id) const;
+
+  //! get cell value for id (new value allocated if not in grid, -2 if no free value)
+  int idValue(int id);
+
+  //! release value of id no longer in grid
+  void freeValue(int v);
+
+  //! get position of id in sorted id values (first entry with id not less than id)
+  uint idValuePos(int id) const;
+
+  //! add/remove id value
+  void setIdValue  (int id, int v);
+  void eraseIdValue(int id);
+
+  //! set cell value at row/column
+  void setValue(int r, int c, int v) {
+    Cell &pc = cells_[uint(cellIndex(r, c, ncols_))];
+
+    if (pc == v)
+      return;
+
+    // update row and column hashes
+    rowHash_[uint(r)] += cellHash(v, colToken_[uint(c)]) - cellHash(pc, colToken_[uint(c)]);
+    colHash_[uint(c)] += cellHash(v, rowToken_[uint(r)]) - cellHash(pc, rowToken_[uint(r)]);
+
+    // update area index
+    removeAreaCell(pc, r, c);
+    addAreaCell   (v , r, c);
+
+    pc = Cell(v);
+  }
+
+  //! bounding box and number of cells for value
+  struct AreaInfo {
+    int  r1     { 0 };     //!< start row
+    int  c1     { 0 };     //!< start column
+    int  r2     { 0 };     //!< end row
+    int  c2     { 0 };     //!< end column
+    int  count  { 0 };     //!< number of cells
+    bool shrunk { false }; //!< edge cell removed (bounding box may be too large)
+
+    bool isRect() const { return (r2 - r1 + 1)*(c2 - c1 + 1) == count; }
+  };
+
+  //! area info for each cell value (indexed by value + 1)
+  typedef CTileSmallVector<AreaInfo, N> AreaInfos;
+
+  //! get area info for value
+  AreaInfo &areaInfo(int v) const {
+    if (uint(v + 1) >= areas_.size())
+      areas_.resize(uint(v + 2));
+
+    return areas_[uint(v + 1)];
+  }
+
+  //! add/remove cell from area index
+  void addAreaCell   (int v, int r, int c) { addAreaCells(v, r, c, r, c, 1); }
+  void removeAreaCell(int v, int r, int c) { removeAreaCells(v, r, c, c); }
+
+  //! add n cells inside range to area index
+  void addAreaCells(int v, int r1, int c1, int r2, int c2, int n);
+  //! remove cells in row span from area index (value is freed if no cells left)
+  void removeAreaCells(int v, int r, int c1, int c2);
+
+  //! move area bounding boxes to new row/column numbers
+  void remapAreas(const std::vector<int> &rowMap, const std::vector<int> &colMap);
+
+  //! shrink bounding boxes of areas which had edge cells removed
+  void updateAreas() const;
+
+  //! rebuild area index
+  void reindex();
+
+  //! check if rows/columns have same cells
+  bool rowsEqual(int r1, int r2) const;
+  bool colsEqual(int c1, int c2) const;
+
+ private:
+  typedef uint64_t                  Hash;
+  typedef CTileSmallVector<Hash, N> Hashes;
+
+  //! hash of cell value with row/column token
+  static Hash cellHash(int v, Hash token) {
+    Hash h = (Hash(uint32_t(v)) << 32) ^ token;
+
+    h = (h ^ (h >> 30))*0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27))*0x94d049bb133111ebULL;
+
+    return h ^ (h >> 31);
+  }
+
+  //! get new row/column token
+  Hash newToken() { return cellHash(0, ++lastToken_); }
+
+  //! recalc all row and column hashes
+  void rehash();
+
+ private:
+  //! cell value of id
+  struct IdValue {
+    int id    { 0 };
+    int value { 0 };
+  };
+
+  typedef CTileSmallVector<Cell, N>    Cells;
+  typedef CTileSmallVector<int, N>     Ids;
+  typedef CTileSmallVector<IdValue, N> IdValues; //! sorted by id
+  typedef CTileSmallVector<int, N>     Values;
+
+  Cells  cells_;             //! grid cells
+  int    nrows_;             //! number of rows
+  int    ncols_;             //! number of columns
+  Hashes rowHash_;           //! sum of cell hashes for each row
+  Hashes colHash_;           //! sum of cell hashes for each column
+  Hashes rowToken_;          //! random token for each row (moves with row)
+  Hashes colToken_;          //! random token for each column (moves with column)
+  Hash   lastToken_ { 0 };   //! last token index
+
+  CTileGridEdges rowEdges_;  //! row edge positions
+  CTileGridEdges colEdges_;  //! column edge positions
+
+  mutable AreaInfos areas_;                 //! bounding box and count for each value
+  mutable bool      areasShrunk_ { false }; //! any area bounding box needs shrinking
+
+  Ids      ids_;        //! id for each cell value
+  IdValues idValues_;   //! cell value for each id in grid
+  Values   freeValues_; //! unused cell values
+
+  uint64_t                   stamp_ { 0 }; //! content stamp
+  CTileGridTypes::ChangesRef record_;      //! changes being recorded
 };
 
+//! compact grid (up to 32767 distinct ids)
+typedef CTileGridT<int16_t> CTileGrid;
+
 #endif
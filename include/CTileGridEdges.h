@@ -0,0 +1,135 @@
+#ifndef CTileGridEdges_H
+#define CTileGridEdges_H
+
+#include <CTileSmallVector.h>
+#include <algorithm>
+#include <sys/types.h>
+#include <vector>
+
+// fractional positions (0 at start to 1 at end) of the n + 1 edges of the n rows
+// or columns of a grid.
+// The edges move with the rows/columns when they are inserted or removed: inserted
+// rows/columns are marked as new and have no size (all their edges are at the insert
+// position) and a removed edge merges the rows/columns either side of it, so the
+// relative size of the other rows/columns is unchanged.
+class CTileGridEdges {
+ public:
+  using Positions = CTileSmallVector<double, 17>;
+  using Flags     = CTileSmallVector<bool, 16>;
+
+ public:
+  //! create edges for n rows/columns of equal size
+  explicit CTileGridEdges(int n=0) {
+    reset(n);
+  }
+
+  bool operator==(const CTileGridEdges &edges) const {
+    return (pos_ == edges.pos_ && new_ == edges.new_);
+  }
+
+  bool operator!=(const CTileGridEdges &edges) const { return ! (*this == edges); }
+
+  //! get number of rows/columns
+  int size() const { return int(new_.size()); }
+
+  //! get/set edge position
+  double pos(int i) const { return pos_[uint(i)]; }
+  void setPos(int i, double pos) { pos_[uint(i)] = pos; }
+
+  //! get size of row/column
+  double size(int i) const { return pos_[uint(i + 1)] - pos_[uint(i)]; }
+
+  //! is row/column new (inserted since last clearNew)
+  bool isNew(int i) const { return new_[uint(i)]; }
+
+  //! has new rows/columns
+  bool hasNew() const { return std::find(new_.begin(), new_.end(), true) != new_.end(); }
+
+  //! mark all rows/columns as not new
+  void clearNew() { new_.assign(new_.size(), false); }
+
+  //! reset to n rows/columns of equal size
+  void reset(int n) {
+    pos_.resize(uint(n + 1));
+    new_.assign(uint(n), false);
+
+    for (int i = 0; i <= n; ++i)
+      pos_[uint(i)] = (n > 0 ? double(i)/n : 0.0);
+  }
+
+  //! insert new rows/columns for number of new rows/columns before each old
+  //! row/column (and at end) to give n rows/columns
+  void insert(const std::vector<int> &shift, int n) {
+    int n1 = size();
+
+    Positions pos(uint(n + 1), pos_[uint(n1)]);
+    Flags     isNew(uint(n), true);
+
+    // new edges before old edge are at old edge
+    for (int i = 0; i <= n1; ++i) {
+      int i1 = i + (i > 0 ? shift[uint(i - 1)] : 0);
+      int i2 = std::min(i + shift[uint(i)], n);
+
+      for (int j = i1; j <= i2; ++j)
+        pos[uint(j)] = pos_[uint(i)];
+
+      if (i < n1 && i2 < n)
+        isNew[uint(i2)] = new_[uint(i)];
+    }
+
+    pos_.swap(pos);
+    new_.swap(isNew);
+  }
+
+  //! remove edges with removed flag set (first and last edge are kept).
+  //! merged row/column is only new if both rows/columns are new
+  void remove(const std::vector<bool> &removed) {
+    uint n = pos_.size();
+    uint j = 1;
+
+    for (uint i = 1; i < n; ++i) {
+      if (i < n - 1 && i < removed.size() && removed[i]) {
+        new_[j - 1] = (new_[j - 1] && new_[i]);
+        continue;
+      }
+
+      pos_[j] = pos_[i];
+
+      if (i < n - 1)
+        new_[j] = new_[i];
+
+      ++j;
+    }
+
+    pos_.resize(j);
+    new_.resize(j - 1);
+  }
+
+  //! remove rows/columns with removed flag set. Removed row/column merges with the
+  //! kept row/column before it (or after it if there is none before)
+  void erase(const std::vector<bool> &removed) {
+    int n = size();
+
+    std::vector<bool> edges(uint(n + 1), false);
+
+    bool kept = false;
+
+    for (int i = 0; i < n; ++i) {
+      if (uint(i) < removed.size() && removed[uint(i)])
+        edges[uint(kept ? i : i + 1)] = true;
+      else
+        kept = true;
+    }
+
+    if (! kept)
+      reset(0);
+    else
+      remove(edges);
+  }
+
+ private:
+  Positions pos_; //!< edge positions
+  Flags     new_; //!< row/column is new
+};
+
+#endif
@@ -0,0 +1,321 @@
+#ifndef CTileGridTypes_H
+#define CTileGridTypes_H
+
+#include <algorithm>
+#include <sys/types.h>
+#include <cstdint>
+#include <vector>
+
+// grid result, row/column insert and recorded change types (used by CTileGrid
+// and its users)
+namespace CTileGridTypes {
+  //! result of fill empty cells
+  struct FillResult {
+    bool failed   { false }; //!< failed to fill all empty cells (grid is unchanged)
+    int  numEmpty { 0 };     //!< number of empty regions which could not be filled
+    int  row1     { -1 };    //!< first unfilled empty region start row
+    int  col1     { -1 };    //!< first unfilled empty region start column
+    int  row2     { -1 };    //!< first unfilled empty region end row
+    int  col2     { -1 };    //!< first unfilled empty region end column
+
+    FillResult() { }
+  };
+
+  //! row/column insertion (count new rows/columns before row/column pos)
+  struct Insert {
+    int pos   { 0 }; //!< row/column position (before insert)
+    int count { 0 }; //!< number of rows/columns to insert
+
+    Insert() { }
+
+    Insert(int pos, int count) :
+     pos(pos), count(count) {
+    }
+  };
+
+  using Inserts = std::vector<Insert>;
+
+  //! rectangular region of cells with the same id
+  struct AreaRegion {
+    int id    { -1 }; //!< cell id
+    int row   { 0 };  //!< start row
+    int col   { 0 };  //!< start column
+    int nrows { 0 };  //!< number of rows
+    int ncols { 0 };  //!< number of columns
+
+    AreaRegion() { }
+
+    AreaRegion(int id, int row, int col, int nrows, int ncols) :
+     id(id), row(row), col(col), nrows(nrows), ncols(ncols) {
+    }
+  };
+
+  using AreaRegions = std::vector<AreaRegion>;
+
+  //! calc number of inserted rows/columns before each of n rows/columns (and at end).
+  //! Insert positions are clamped to the rows/columns.
+  inline int calcShift(const Inserts &inserts, int n, std::vector<int> &shift) {
+    shift.assign(uint(n + 1), 0);
+
+    for (const auto &insert : inserts) {
+      if (insert.count <= 0) continue;
+
+      shift[uint(std::min(std::max(insert.pos, 0), n))] += insert.count;
+    }
+
+    for (int i = 1; i <= n; ++i)
+      shift[uint(i)] += shift[uint(i - 1)];
+
+    return shift[uint(n)];
+  }
+
+  //! get new grid content stamp (unique over all grids). Grids with the same stamp
+  //! have the same cells
+  inline uint64_t newStamp() {
+    static uint64_t stamp = 0;
+
+    return ++stamp;
+  }
+
+  //! changed cell (cell index and old and new id)
+  struct CellChange {
+    int ind { 0 };  //!< cell index
+    int id1 { -1 }; //!< old id
+    int id2 { -1 }; //!< new id
+
+    CellChange() { }
+
+    CellChange(int ind, int id1, int id2) :
+     ind(ind), id1(id1), id2(id2) {
+    }
+  };
+
+  using CellChanges = std::vector<CellChange>;
+
+  //! recorded grid change (only the data for its type is set)
+  struct Change {
+    enum class Type {
+      CELLS,   //!< cells changed (cells in change order)
+      REPLACE, //!< id1 renamed to id2 (id2 not in grid before)
+      INSERT,  //!< rows/columns inserted (inserts and new rows/columns)
+      REMOVE,  //!< rows/columns removed (removed rows/columns and their cells)
+      RESIZE   //!< all cells set (old and new size and cells)
+    };
+
+    Type              type   { Type::CELLS };
+    CellChanges       cells;         //!< changed cells
+    int               id1    { -1 }; //!< old id of replace
+    int               id2    { -1 }; //!< new id of replace
+    Inserts           rowInserts;    //!< row inserts
+    Inserts           colInserts;    //!< column inserts
+    std::vector<bool> rows;          //!< inserted (new) or removed (old) rows
+    std::vector<bool> cols;          //!< inserted (new) or removed (old) columns
+    int               nrows1 { 0 };  //!< old number of rows of resize
+    int               ncols1 { 0 };  //!< old number of columns of resize
+    int               nrows2 { 0 };  //!< new number of rows of resize
+    int               ncols2 { 0 };  //!< new number of columns of resize
+    std::vector<int>  ids1;          //!< old cells of resize or cells of removed rows/columns
+    std::vector<int>  ids2;          //!< new cells of resize
+
+    Change() { }
+
+    explicit Change(Type type) :
+     type(type) {
+    }
+  };
+
+  //! changes recorded by a grid (see setChanges) and grid stamp after last change
+  struct Changes {
+    std::vector<Change> changes; //!< changes (oldest first)
+    uint64_t            stamp { 0 };
+
+    bool empty() const { return changes.empty(); }
+
+    void clear() {
+      changes.clear();
+
+      stamp = 0;
+    }
+
+    //! add change of specified type
+    Change &add(Change::Type type) {
+      changes.push_back(Change(type));
+
+      return changes.back();
+    }
+
+    //! add changed cell (appended to last change if cells changed)
+    void addCell(int ind, int id1, int id2) {
+      if (changes.empty() || changes.back().type != Change::Type::CELLS)
+        add(Change::Type::CELLS);
+
+      changes.back().cells.push_back(CellChange(ind, id1, id2));
+    }
+
+    //! get ids set by applying old (undo) or new (redo) side of changes
+    void getIds(bool undo, std::vector<int> &ids) const {
+      for (const auto &change : changes) {
+        if      (change.type == Change::Type::CELLS) {
+          for (const auto &cell : change.cells)
+            ids.push_back(undo ? cell.id1 : cell.id2);
+        }
+        else if (change.type == Change::Type::REPLACE)
+          ids.push_back(undo ? change.id1 : change.id2);
+        else if (change.type == Change::Type::REMOVE) {
+          if (undo)
+            ids.insert(ids.end(), change.ids1.begin(), change.ids1.end());
+        }
+        else if (change.type == Change::Type::RESIZE) {
+          const auto &ids1 = (undo ? change.ids1 : change.ids2);
+
+          ids.insert(ids.end(), ids1.begin(), ids1.end());
+        }
+      }
+
+      std::sort(ids.begin(), ids.end());
+
+      ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    }
+  };
+
+  //! grid reference to changes being recorded (not copied with grid)
+  struct ChangesRef {
+    Changes *changes { nullptr };
+
+    ChangesRef() { }
+
+    ChangesRef(const ChangesRef &) { }
+
+    ChangesRef &operator=(const ChangesRef &) { return *this; }
+  };
+
+  //! get inserts which add back removed rows/columns (removed flags of old rows/columns)
+  inline void removedInserts(const std::vector<bool> &removed, Inserts &inserts) {
+    int nremoved = 0;
+
+    for (uint i = 0; i < removed.size(); ++i) {
+      if (! removed[i]) continue;
+
+      int pos = int(i) - nremoved++;
+
+      if (! inserts.empty() && inserts.back().pos == pos)
+        ++inserts.back().count;
+      else
+        inserts.push_back(Insert(pos, 1));
+    }
+  }
+
+  //! set all cells of grid (rows of cells with same id are filled as one range)
+  template<typename GRID>
+  bool setGridCells(GRID &grid, int nrows, int ncols, const std::vector<int> &ids) {
+    grid.setSize(nrows, ncols);
+
+    for (int r = 0; r < nrows; ++r) {
+      for (int c = 0; c < ncols; ) {
+        int id = ids[uint(r*ncols + c)];
+
+        int c1 = c + 1;
+
+        while (c1 < ncols && ids[uint(r*ncols + c1)] == id)
+          ++c1;
+
+        if (! grid.fill(r, c, r, c1 - 1, id))
+          return false;
+
+        c = c1;
+      }
+    }
+
+    return true;
+  }
+
+  //! apply old (undo) or new (redo) side of change to grid
+  template<typename GRID>
+  bool applyChange(GRID &grid, const Change &change, bool undo) {
+    switch (change.type) {
+      case Change::Type::CELLS: {
+        // undo restores cells last change first
+        uint n = uint(change.cells.size());
+
+        for (uint i = 0; i < n; ++i) {
+          const CellChange &cell = change.cells[undo ? n - 1 - i : i];
+
+          int ncols = grid.ncols();
+
+          if (! grid.setCell(cell.ind / ncols, cell.ind % ncols, (undo ? cell.id1 : cell.id2)))
+            return false;
+        }
+
+        return true;
+      }
+      case Change::Type::REPLACE:
+        return (undo ? grid.replace(change.id2, change.id1) :
+                       grid.replace(change.id1, change.id2));
+      case Change::Type::INSERT:
+        if (undo) {
+          grid.removeRows(change.rows);
+          grid.removeCols(change.cols);
+        }
+        else
+          grid.insert(change.rowInserts, change.colInserts);
+
+        return true;
+      case Change::Type::REMOVE: {
+        if (! undo) {
+          grid.removeRows(change.rows);
+          grid.removeCols(change.cols);
+
+          return true;
+        }
+
+        // insert removed rows/columns back and restore their cells
+        Inserts rowInserts, colInserts;
+
+        removedInserts(change.rows, rowInserts);
+        removedInserts(change.cols, colInserts);
+
+        grid.insert(rowInserts, colInserts);
+
+        uint i = 0;
+
+        for (int r = 0; r < int(change.rows.size()); ++r) {
+          if (! change.rows[uint(r)]) continue;
+
+          for (int c = 0; c < grid.ncols(); ++c)
+            if (! grid.setCell(r, c, change.ids1[i++])) return false;
+        }
+
+        for (int c = 0; c < int(change.cols.size()); ++c) {
+          if (! change.cols[uint(c)]) continue;
+
+          for (int r = 0; r < grid.nrows(); ++r)
+            if (! grid.setCell(r, c, change.ids1[i++])) return false;
+        }
+
+        return true;
+      }
+      case Change::Type::RESIZE:
+        if (undo)
+          return setGridCells(grid, change.nrows1, change.ncols1, change.ids1);
+        else
+          return setGridCells(grid, change.nrows2, change.ncols2, change.ids2);
+    }
+
+    return false;
+  }
+
+  //! apply old (undo, last change first) or new (redo) side of changes to grid
+  template<typename GRID>
+  bool applyChanges(GRID &grid, const Changes &changes, bool undo) {
+    uint n = uint(changes.changes.size());
+
+    for (uint i = 0; i < n; ++i) {
+      if (! applyChange(grid, changes.changes[undo ? n - 1 - i : i], undo))
+        return false;
+    }
+
+    return true;
+  }
+}
+
+#endif
@@ -0,0 +1,379 @@
+#ifndef CTileLayout_H
+#define CTileLayout_H
+
+#include <CTileGrid.h>
+
+#include <CTileSmallVector.h>
+
+#include <climits>
+#include <map>
+#include <vector>
+
+//! layout engine for tile area (no Qt dependency).
+//! converts a grid of area ids into placement areas (physical geometry) and the
+//! splitters between them. The size of each row and column is stored in the grid
+//! as fractional edge positions (CTileGridEdges) which are mapped to the layout
+//! size, and only solved (CTileConstraintSolver) when the mapped positions do not
+//! meet the size constraints of the areas. Each placement area rectangle is then
+//! given by the positions of its first and last row and column edges
+class CTileLayout {
+ public:
+  using Grid = CTileGrid;
+
+  //! size
+  struct Size {
+    int width  { 0 };
+    int height { 0 };
+
+    Size() { }
+
+    Size(int width, int height) :
+     width(width), height(height) {
+    }
+  };
+
+  //! area size constraints
+  struct AreaSize {
+    Size minSize;                      //!< minimum size
+    Size maxSize { INT_MAX, INT_MAX }; //!< maximum size (fixed size if same as minimum)
+
+    AreaSize() { }
+
+    AreaSize(const Size &minSize, const Size &maxSize=Size(INT_MAX, INT_MAX)) :
+     minSize(minSize), maxSize(maxSize) {
+    }
+  };
+
+  //! rectangle
+  struct Rect {
+    int x      { 0 };
+    int y      { 0 };
+    int width  { 0 };
+    int height { 0 };
+
+    Rect() { }
+
+    Rect(int x, int y, int width, int height) :
+     x(x), y(y), width(width), height(height) {
+    }
+  };
+
+  //! structure to store physical placement area of area
+  struct PlacementArea {
+    int row    { 0 };  //!< row
+    int col    { 0 };  //!< column
+    int nrows  { 1 };  //!< number of rows
+    int ncols  { 1 };  //!< number of columns
+    int areaId { -1 }; //!< associated area (can be invalid (<= 0))
+    int x      { 0 };  //!< x
+    int y      { 0 };  //!< y
+    int width  { 1 };  //!< width
+    int height { 1 };  //!< height
+
+    int row1() const { return row        ; }
+    int col1() const { return col        ; }
+    int row2() const { return row + nrows; }
+    int col2() const { return col + ncols; }
+
+    int x1() const { return x         ; }
+    int y1() const { return y         ; }
+    int x2() const { return x + width ; }
+    int y2() const { return y + height; }
+
+    int xm() const { return x + width /2; }
+    int ym() const { return y + height/2; }
+
+    void place(int r, int c, int nr, int nc, int id) {
+      row    = r;
+      col    = c;
+      nrows  = nr;
+      ncols  = nc;
+      areaId = id;
+      x      = col*100;
+      y      = row*100;
+      width  = 100*nc;
+      height = 100*nr;
+    }
+
+    Rect rect() const { return Rect(x, y, width, height); }
+
+    //! check if same cells, area and geometry
+    bool isSame(const PlacementArea &area) const {
+      return (row   == area.row   && col    == area.col    &&
+              nrows == area.nrows && ncols  == area.ncols  && areaId == area.areaId &&
+              x     == area.x     && y      == area.y      &&
+              width == area.width && height == area.height);
+    }
+  };
+
+  //! sorted placement area indices (small sets are stored inline so splitters and
+  //! saved placement states copy without allocation and splitter rectangles and area
+  //! splitter lists iterate contiguous memory)
+  using AreaSet = CTileSmallVector<int, 4>;
+
+  //! structure to store horizontal splitter geometry
+  struct HSplitter {
+    int      col1 { -1 };       //!< min col extend of splitter (needed ?)
+    int      col2 { -1 };       //!< max col extend of splitter (needed ?)
+    AreaSet  tareas;            //!< areas above splitter
+    AreaSet  bareas;            //!< areas below splitter
+    int      splitterId { -1 }; //!< splitter widget id
+
+    HSplitter() { }
+
+    bool operator==(const HSplitter &s) const {
+      return (col1 == s.col1 && col2 == s.col2 && tareas == s.tareas &&
+              bareas == s.bareas && splitterId == s.splitterId);
+    }
+  };
+
+  //! structure to store vertical splitter geometry
+  struct VSplitter {
+    int      row1 { -1 };       //!< min row extend of splitter (needed ?)
+    int      row2 { -1 };       //!< max row extend of splitter (needed ?)
+    AreaSet  lareas;            //!< areas left of splitter
+    AreaSet  rareas;            //!< areas right of splitter
+    int      splitterId { -1 }; //!< splitter widget id
+
+    VSplitter() { }
+
+    bool operator==(const VSplitter &s) const {
+      return (row1 == s.row1 && row2 == s.row2 && lareas == s.lareas &&
+              rareas == s.rareas && splitterId == s.splitterId);
+    }
+  };
+
+  using AreaSizes         = std::map<int, AreaSize>;
+  using AreaIndices       = std::vector<int>;
+  using PlacementAreas    = std::vector<PlacementArea>;
+  using HSplitterArray    = std::vector<HSplitter>;
+  using RowHSplitterArray = std::map<int, HSplitterArray>;
+  using VSplitterArray    = std::vector<VSplitter>;
+  using ColVSplitterArray = std::map<int, VSplitterArray>;
+
+ public:
+  //! create layout
+  CTileLayout() { }
+
+  //! get/set layout size
+  int  width () const { return width_ ; }
+  int  height() const { return height_; }
+  void setSize(int w, int h);
+
+  //! get/set border
+  int  border() const { return border_; }
+  void setBorder(int border);
+
+  //! get/set splitter size
+  int  splitterSize() const { return splitterSize_; }
+  void setSplitterSize(int size);
+
+  //! get/set minimum size of placement area without an area
+  int  minSize() const { return minSize_; }
+  void setMinSize(int size);
+
+  //! set default placement size (size of empty cell)
+  void setDefPlacementSize(int w, int h) { defWidth_ = w; defHeight_ = h; }
+
+  //! get/set size constraints of areas (keyed by area id).
+  //! only ids in this map are valid grid area ids
+  const AreaSizes &areaSizes() const { return areaSizes_; }
+  void setAreaSizes(const AreaSizes &sizes);
+
+  //! set size constraints of single area (only its placement areas are updated)
+  void setAreaSize(int areaId, const AreaSize &size);
+
+  //! get grid
+  Grid       &grid()       { return grid_; }
+  const Grid &grid() const { return grid_; }
+
+  //! get placement areas.
+  //! area id changes must use setPlacementAreaId (or be followed by a call to
+  //! updatePlacementAreaIndices) to keep the area id lookup valid
+  PlacementAreas       &placementAreas()       { return placementAreas_; }
+  const PlacementAreas &placementAreas() const { return placementAreas_; }
+
+  //! get horizontal splitters
+  RowHSplitterArray       &hsplitters()       { return hsplitters_; }
+  const RowHSplitterArray &hsplitters() const { return hsplitters_; }
+
+  //! get vertical splitters
+  ColVSplitterArray       &vsplitters()       { return vsplitters_; }
+  const ColVSplitterArray &vsplitters() const { return vsplitters_; }
+
+  //! update placement (and splitters) from grid.
+  //! returns false if grid has area ids with no size constraints (not placed), these
+  //! are added (sorted) to invalidIds if specified
+  bool gridToPlacement(bool useExisting=true, std::vector<int> *invalidIds=nullptr);
+
+  //! add splitters between cells
+  void addSplitters();
+
+  //! adjust sizes of cells to fit layout size (only re-solves changed axes)
+  void adjustToFit();
+
+  //! resize layout and adjust sizes of cells to fit (only changed axes).
+  //! returns the (sorted) indices of the placement areas with changed geometry
+  void resize(int w, int h, std::vector<int> &changed);
+
+  //! get position of row/column edge (start of splitter, end of area before edge)
+  int rowPos(int r) const { return rowPos_[uint(r)]; }
+  int colPos(int c) const { return colPos_[uint(c)]; }
+
+  //! start drag of horizontal splitters at row edge (precomputes allowed offset range
+  //! and the edges pushed by areas at their minimum size)
+  bool beginHSplitterDrag(int row);
+  //! start drag of vertical splitters at column edge (precomputes allowed offset range
+  //! and the edges pushed by areas at their minimum size)
+  bool beginVSplitterDrag(int col);
+
+  //! move dragged edge to offset from its start position (limited to allowed range).
+  //! returns applied offset and (sorted) indices of placement areas with changed geometry
+  int dragSplitter(int d, std::vector<int> &changed);
+
+  //! end splitter drag
+  void endSplitterDrag() { drag_.active = false; }
+
+  //! is splitter drag active
+  bool isSplitterDrag() const { return drag_.active; }
+
+  //! check if an axis needs a full solve
+  bool isDirty() const { return (xdirty_ || ydirty_); }
+
+  //! force full solve of both axes on next adjustToFit (after external changes
+  //! to placement areas or splitters)
+  void invalidate() { xdirty_ = true; ydirty_ = true; }
+
+  //! get placement area index from id (first placement area for id, -1 if none or id < 0)
+  int getPlacementAreaIndex(int id) const {
+    return getPlacementAreaIndex(areaIndices_, id);
+  }
+
+  //! set area id of placement area at index (updates area id lookup and size
+  //! constraints of placement area, layout is only refit if area does not fit them)
+  void setPlacementAreaId(int ind, int areaId);
+
+  //! rebuild area id lookup from placement areas
+  void updatePlacementAreaIndices();
+
+  //! get horizontal splitter rectangle
+  Rect getHSplitterRect(const HSplitter &splitter) const;
+  //! get vertical splitter rectangle
+  Rect getVSplitterRect(const VSplitter &splitter) const;
+
+ private:
+  //! edge of placement area at row/column (splitter candidate)
+  struct Edge {
+    int  pos   { 0 };     //!< edge row/column
+    int  start { 0 };     //!< start column/row
+    int  end   { 0 };     //!< end column/row
+    int  ind   { -1 };    //!< placement area index
+    bool after { false }; //!< placement area is after (below/right of) edge
+
+    Edge() { }
+
+    Edge(int pos, int start, int end, int ind, bool after) :
+     pos(pos), start(start), end(end), ind(ind), after(after) {
+    }
+  };
+
+  using Edges = std::vector<Edge>;
+
+  //! placement area span between edges along axis
+  struct Span {
+    int var1    { 0 };       //!< start edge
+    int var2    { -1 };      //!< end edge
+    int minSize { 0 };       //!< minimum size
+    int maxSize { INT_MAX }; //!< maximum size
+  };
+
+  using Spans     = std::vector<Span>;
+  using Positions = std::vector<int>;
+
+  //! placement area span moved by splitter drag
+  struct DragSpan {
+    int  ind     { -1 };      //!< placement area index
+    int  var1    { 0 };       //!< start edge
+    int  var2    { -1 };      //!< end edge
+    int  minSize { 0 };       //!< minimum edge distance (pushes edge)
+    int  maxSize { INT_MAX }; //!< maximum edge distance (limits drag)
+    bool push    { false };   //!< span pushes edge (else only resized)
+  };
+
+  using DragSpans = std::vector<DragSpan>;
+  using DragEdges = std::vector<int>;
+
+  //! splitter drag session (spans and edges moved by drag back and forward)
+  struct SplitterDrag {
+    bool      active     { false }; //!< is active
+    bool      horizontal { true };  //!< drag of row edge (horizontal splitters)
+    int       edge       { -1 };    //!< dragged edge
+    int       minDelta   { 0 };     //!< minimum offset
+    int       maxDelta   { 0 };     //!< maximum offset
+    int       delta      { 0 };     //!< current offset
+    Positions startPos;             //!< edge positions at start of drag
+    DragSpans spans[2];             //!< moved spans (push spans in push order first)
+    DragEdges edges[2];             //!< moved edges (including dragged edge)
+  };
+
+ private:
+  //! add placement area index to area set (keeps set sorted and unique)
+  static void addAreaSetInd(AreaSet &areas, int ind);
+
+  //! get size constraints of area (minimum size for placement area without area)
+  AreaSize getAreaSize(int areaId) const;
+
+  //! give new rows/columns the default size (if > 0) and rescale edges to fit
+  void initEdges(CTileGridEdges &edges, int len, int defSize) const;
+
+  //! set column edge positions and placement x/width (adds changed placement areas)
+  void fitWidth (std::vector<int> *changed=nullptr);
+  //! set row edge positions and placement y/height (adds changed placement areas)
+  void fitHeight(std::vector<int> *changed=nullptr);
+
+  //! map edges to positions between pos1 and pos2 (solved if spans do not fit)
+  void fitEdges(const CTileGridEdges &edges, const Spans &spans, int pos1, int pos2,
+                Positions &pos) const;
+
+  //! set inner edges which do not map to their (solved) position to that position
+  static void syncEdges(CTileGridEdges &edges, const Positions &pos, int pos1, int pos2);
+
+  //! init drag of edge from spans along drag axis and current edge positions
+  bool initSplitterDrag(bool horizontal, int edge, const Spans &spans, const Positions &pos);
+
+  //! set edge positions for drag offset (false if offset breaks area size or moves border)
+  bool setDragPositions(int d, Positions &pos) const;
+
+  //! set drag offset range from drag spans and edge positions at drag start
+  void calcDragRange();
+
+  //! update size constraints of placement area (for new area)
+  void updatePlacementAreaSize(int ind);
+
+  //! get placement area index from id in area id lookup
+  static int getPlacementAreaIndex(const AreaIndices &areaIndices, int id) {
+    return (id >= 0 && uint(id) < areaIndices.size() ? areaIndices[uint(id)] : -1);
+  }
+
+ private:
+  Grid              grid_;                   //!< layout grid
+  PlacementAreas    placementAreas_;         //!< placed areas
+  AreaIndices       areaIndices_;            //!< placement area index for area id (-1 if none)
+  RowHSplitterArray hsplitters_;             //!< horizontal splitters
+  ColVSplitterArray vsplitters_;             //!< vertical splitters
+  Positions         rowPos_;                 //!< row edge positions
+  Positions         colPos_;                 //!< column edge positions
+  AreaSizes         areaSizes_;              //!< area minimum sizes
+  int               width_        { 0 };     //!< layout width
+  int               height_       { 0 };     //!< layout height
+  int               border_       { 0 };     //!< border
+  int               splitterSize_ { 3 };     //!< splitter size
+  int               minSize_      { 16 };    //!< min size of placement without area
+  int               defWidth_     { -1 };    //!< default (new) area width
+  int               defHeight_    { -1 };    //!< default (new) area height
+  bool              xdirty_       { true };  //!< x positions need solve
+  bool              ydirty_       { true };  //!< y positions need solve
+  SplitterDrag      drag_;                   //!< current splitter drag
+};
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef CTileRectIndex_H
+#define CTileRectIndex_H
+
+#include <vector>
+#include <sys/types.h>
+
+// uniform bucket index of (pixel) rectangles for point queries.
+// Each rectangle is stored in every fixed size bucket it overlaps so a point query
+// only checks the rectangles of the bucket containing the point.
+// The index is (re)built lazily on the first query after a rectangle is changed.
+class CTileRectIndex {
+ public:
+  //! rectangle (x, y, width, height)
+  struct Rect {
+    int x      { 0 }; //!< left
+    int y      { 0 }; //!< top
+    int width  { 0 }; //!< width
+    int height { 0 }; //!< height
+
+    Rect() { }
+
+    Rect(int x, int y, int width, int height) :
+     x(x), y(y), width(width), height(height) {
+    }
+
+    bool isEmpty() const { return (width <= 0 || height <= 0); }
+
+    bool inside(int px, int py) const {
+      return (px >= x && px < x + width && py >= y && py < y + height);
+    }
+
+    bool overlaps(const Rect &r) const {
+      return (x < r.x + r.width && r.x < x + width && y < r.y + r.height && r.y < y + height);
+    }
+
+    bool operator==(const Rect &r) const {
+      return (x == r.x && y == r.y && width == r.width && height == r.height);
+    }
+
+    bool operator!=(const Rect &r) const { return ! (*this == r); }
+  };
+
+  using Rects = std::vector<Rect>;
+
+ public:
+  //! create index with specified bucket size
+  explicit CTileRectIndex(int bucketSize=64);
+
+  //! get number of rectangles
+  int size() const { return int(rects_.size()); }
+
+  //! reset to n empty rectangles
+  void reset(int n);
+
+  //! get/set rectangle
+  const Rect &rect(int i) const { return rects_[uint(i)]; }
+  void setRect(int i, const Rect &rect);
+
+  //! get first (lowest index) rectangle containing point (-1 if none)
+  int find(int x, int y) const;
+
+  //! get (sorted) indices of rectangles overlapping rectangle
+  void findOverlapping(const Rect &rect, std::vector<int> &inds) const;
+
+ private:
+  using Inds        = std::vector<int>;
+  using BucketArray = std::vector<Inds>;
+
+  //! rebuild bucket index (if needed)
+  void updateIndex() const;
+
+ private:
+  int                 bucketSize_ { 64 };    //!< bucket size
+  Rects               rects_;                //!< rectangles
+  mutable BucketArray buckets_;              //!< rectangle indices in each bucket
+  mutable int         bx_         { 0 };     //!< x of first bucket
+  mutable int         by_         { 0 };     //!< y of first bucket
+  mutable int         nbx_        { 0 };     //!< number of bucket columns
+  mutable int         nby_        { 0 };     //!< number of bucket rows
+  mutable bool        indexValid_ { false }; //!< is bucket index valid
+};
+
+#endif
@@ -0,0 +1,220 @@
+#ifndef CTileSmallVector_H
+#define CTileSmallVector_H
+
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+// vector of trivially copyable values which stores up to N values inline and
+// only allocates heap storage for more.
+// Copies of small vectors are a single memcpy with no allocation.
+template<typename T, int N>
+class CTileSmallVector {
+  static_assert(std::is_trivially_copyable<T>::value, "value must be trivially copyable");
+  static_assert(N >= 0, "inline size must be positive");
+
+ public:
+  typedef T        value_type;
+  typedef T       *iterator;
+  typedef const T *const_iterator;
+
+  //! inline capacity
+  static constexpr unsigned inlineSize() { return unsigned(N); }
+
+ public:
+  CTileSmallVector() { }
+
+  explicit CTileSmallVector(unsigned n, const T &v=T()) {
+    assign(n, v);
+  }
+
+  CTileSmallVector(const CTileSmallVector &vec) {
+    copy(vec);
+  }
+
+  CTileSmallVector(CTileSmallVector &&vec) {
+    move(vec);
+  }
+
+ ~CTileSmallVector() {
+    delete [] heap_;
+  }
+
+  CTileSmallVector &operator=(const CTileSmallVector &vec) {
+    if (&vec != this)
+      copy(vec);
+
+    return *this;
+  }
+
+  CTileSmallVector &operator=(CTileSmallVector &&vec) {
+    if (&vec != this) {
+      delete [] heap_;
+
+      heap_     = nullptr;
+      capacity_ = N;
+
+      move(vec);
+    }
+
+    return *this;
+  }
+
+  //! compare values
+  bool operator==(const CTileSmallVector &vec) const {
+    if (vec.size_ != size_)
+      return false;
+
+    for (unsigned i = 0; i < size_; ++i)
+      if (! (data()[i] == vec.data()[i])) return false;
+
+    return true;
+  }
+
+  bool operator!=(const CTileSmallVector &vec) const { return ! (*this == vec); }
+
+  //! get size/check empty
+  unsigned size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  //! check if values are on heap
+  bool isHeap() const { return heap_ != nullptr; }
+
+  //! get value data
+  T       *data()       { return (heap_ ? heap_ : buf_); }
+  const T *data() const { return (heap_ ? heap_ : buf_); }
+
+  //! get value at index
+  T       &operator[](unsigned i)       { return data()[i]; }
+  const T &operator[](unsigned i) const { return data()[i]; }
+
+  //! iterators
+  iterator       begin()       { return data(); }
+  iterator       end  ()       { return data() + size_; }
+  const_iterator begin() const { return data(); }
+  const_iterator end  () const { return data() + size_; }
+
+  //! get last value
+  T       &back()       { return data()[size_ - 1]; }
+  const T &back() const { return data()[size_ - 1]; }
+
+  //! add/remove last value
+  void push_back(const T &v) {
+    if (size_ == capacity_) {
+      T v1 = v; // v may be in storage being reallocated
+
+      reserve(2*capacity_ + 1);
+
+      data()[size_++] = v1;
+    }
+    else
+      data()[size_++] = v;
+  }
+
+  void pop_back() { --size_; }
+
+  //! insert value at index
+  void insert(unsigned i, const T &v) {
+    T v1 = v; // v may be in storage being moved
+
+    push_back(v1);
+
+    T *d = data();
+
+    std::memmove(static_cast<void *>(d + i + 1), d + i, (size_ - i - 1)*sizeof(T));
+
+    d[i] = v1;
+  }
+
+  //! erase value at index
+  void erase(unsigned i) {
+    T *d = data();
+
+    std::memmove(static_cast<void *>(d + i), d + i + 1, (size_ - i - 1)*sizeof(T));
+
+    --size_;
+  }
+
+  //! remove all values (capacity is kept)
+  void clear() { size_ = 0; }
+
+  //! resize (new values set to v)
+  void resize(unsigned n, const T &v=T()) {
+    reserve(n);
+
+    T *d = data();
+
+    for (unsigned i = size_; i < n; ++i)
+      d[i] = v;
+
+    size_ = n;
+  }
+
+  //! set to n values of v
+  void assign(unsigned n, const T &v) {
+    size_ = 0;
+
+    resize(n, v);
+  }
+
+  //! ensure capacity for n values
+  void reserve(unsigned n) {
+    if (n <= capacity_)
+      return;
+
+    T *heap = new T [n];
+
+    std::memcpy(static_cast<void *>(heap), data(), size_*sizeof(T));
+
+    delete [] heap_;
+
+    heap_     = heap;
+    capacity_ = n;
+  }
+
+  void swap(CTileSmallVector &vec) {
+    CTileSmallVector vec1(std::move(vec));
+
+    vec  = std::move(*this);
+    *this = std::move(vec1);
+  }
+
+ private:
+  void copy(const CTileSmallVector &vec) {
+    size_ = 0;
+
+    reserve(vec.size_);
+
+    std::memcpy(static_cast<void *>(data()), vec.data(), vec.size_*sizeof(T));
+
+    size_ = vec.size_;
+  }
+
+  // take heap storage from (or copy inline values of) other vector
+  void move(CTileSmallVector &vec) {
+    if (vec.heap_) {
+      heap_     = vec.heap_;
+      capacity_ = vec.capacity_;
+      size_     = vec.size_;
+
+      vec.heap_     = nullptr;
+      vec.capacity_ = N;
+      vec.size_     = 0;
+    }
+    else {
+      std::memcpy(static_cast<void *>(buf_), vec.buf_, vec.size_*sizeof(T));
+
+      size_ = vec.size_;
+
+      vec.size_ = 0;
+    }
+  }
+
+ private:
+  T        buf_[N > 0 ? N : 1];   //!< inline values
+  T       *heap_     { nullptr }; //!< heap values (if more than N)
+  unsigned size_     { 0 };       //!< number of values
+  unsigned capacity_ { N };       //!< current capacity
+};
+
+#endif
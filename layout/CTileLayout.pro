@@ -0,0 +1,33 @@
+TEMPLATE = lib
+
+TARGET = CTileLayout
+
+CONFIG -= qt
+CONFIG += staticlib
+
+DEPENDPATH += .
+
+QMAKE_CXXFLAGS += -std=c++17
+
+# Input
+HEADERS += \
+../include/CTileConstraintSolver.h \
+../include/CTileGrid.h \
+../include/CTileGridEdges.h \
+../include/CTileGridTypes.h \
+../include/CTileLayout.h \
+../include/CTileRectIndex.h \
+../include/CTileSmallVector.h \
+
+SOURCES += \
+../src/CTileConstraintSolver.cpp \
+../src/CTileGrid.cpp \
+../src/CTileLayout.cpp \
+../src/CTileRectIndex.cpp \
+
+OBJECTS_DIR = ../obj/layout
+
+DESTDIR = ../lib
+
+INCLUDEPATH += \
+../include \
@@ -11,12 +11,19 @@
 #include <CQRubberBand.h>
 
 #include <QMainWindow>
+#include <QMouseEvent>
+#include <QPaintEvent>
+#include <QStylePainter>
+#include <QStyleOption>
 #include <QApplication>
 #include <QDesktopWidget>
 #include <QMenuBar>
 #include <QScreen>
+#include <QTimer>
 
+#include <algorithm>
 #include <cassert>
+#include <climits>
 #include <set>
 #include <iostream>
 #include <cmath>
@@ -64,6 +71,27 @@ setTitleInactiveColor(const QColor &color)
   titleInactiveColor_ = color;
 }
 
+// set splitters drawn by area (no splitter widgets) or drawn by splitter widgets
+void
+CQTileArea::
+setPaintSplitters(bool paint)
+{
+  if (paint == paintSplitters_)
+    return;
+
+  paintSplitters_ = paint;
+
+  // painted splitter no longer gets mouse release so end its drag now
+  if (! paintSplitters_)
+    endSplitterMouseDrag();
+
+  updateSplitterWidgets();
+
+  updateSplitterGeometries();
+
+  update();
+}
+
 // add window as a new column in the grid
 CQTileWindow *
 CQTileArea::
@@ -105,6 +133,9 @@ addArea()
 
   areas_[windowArea->id()] = windowArea;
 
+  // cached size hints are invalidated by layout request of area
+  windowArea->installEventFilter(this);
+
   setCurrentArea(windowArea);
 
   return windowArea;
@@ -115,23 +146,36 @@ void
 CQTileArea::
 addWindowArea(CQTileWindowArea *windowArea, int row, int col, int nrows, int ncols)
 {
+  // preview (no window area) is not recorded for undo
+  if (windowArea)
+    beginUndoStep();
+
+  // add edge rows and columns in a single grid update
+  Grid::Inserts rowInserts, colInserts;
+
   // insert top
   if      (row < 0) {
-    insertRows(0, -row);
+    rowInserts.push_back(Grid::Insert(0, -row));
     row = 0;
   }
   // insert bottom
-  else if (row >= grid_.nrows())
-    insertRows(grid_.nrows(), row - grid_.nrows() + 1);
+  else if (row >= grid().nrows())
+    rowInserts.push_back(Grid::Insert(grid().nrows(), row - grid().nrows() + 1));
+
+  // inserted rows have at least one column
+  int ncols1    = (! rowInserts.empty() ? std::max(grid().ncols(), 1) : grid().ncols());
+  int extraCols = ncols1 - grid().ncols();
 
   // insert left
   if      (col < 0) {
-    insertColumns(0, -col);
+    colInserts.push_back(Grid::Insert(0, -col + extraCols));
     col = 0;
   }
   // insert right
-  else if (col >= grid_.ncols())
-    insertColumns(grid_.ncols(), col - grid_.ncols() + 1);
+  else if (col >= ncols1)
+    colInserts.push_back(Grid::Insert(grid().ncols(), col - ncols1 + 1 + extraCols));
+
+  grid().insert(rowInserts, colInserts);
 
   //------
 
@@ -145,7 +189,7 @@ addWindowArea(CQTileWindowArea *windowArea, int row, int col, int nrows, int nco
 
   for (int r = row; ! overlap && r <= row1; ++r) {
     for (int c = col; ! overlap && c <= col1; ++c) {
-      if (grid_.cell(r, c) < 0) continue;
+      if (grid().cell(r, c) < 0) continue;
 
       overlap = true;
 
@@ -157,11 +201,11 @@ addWindowArea(CQTileWindowArea *windowArea, int row, int col, int nrows, int nco
     if (nrows > ncols) {
       int splitCol = col;
 
-      for ( ; splitCol > 0 && splitCol < grid_.ncols(); ++splitCol) {
+      for ( ; splitCol > 0 && splitCol < grid().ncols(); ++splitCol) {
         bool valid = true;
 
-        for (int r = 0; r < grid_.nrows(); ++r) {
-          if (grid_.cell(r, splitCol - 1) == grid_.cell(r, splitCol)) {
+        for (int r = 0; r < grid().nrows(); ++r) {
+          if (grid().cell(r, splitCol - 1) == grid().cell(r, splitCol)) {
             valid = false;
             break;
           }
@@ -179,11 +223,11 @@ addWindowArea(CQTileWindowArea *windowArea, int row, int col, int nrows, int nco
     else {
       int splitRow = row;
 
-      for ( ; splitRow > 0 && splitRow < grid_.nrows(); ++splitRow) {
+      for ( ; splitRow > 0 && splitRow < grid().nrows(); ++splitRow) {
         bool valid = true;
 
-        for (int c = 0; c < grid_.ncols(); ++c) {
-          if (grid_.cell(splitRow - 1, c) == grid_.cell(splitRow, c)) {
+        for (int c = 0; c < grid().ncols(); ++c) {
+          if (grid().cell(splitRow - 1, c) == grid().cell(splitRow, c)) {
             valid = false;
             break;
           }
@@ -202,15 +246,19 @@ addWindowArea(CQTileWindowArea *windowArea, int row, int col, int nrows, int nco
 
   //------
 
-  // store area in grid
+  // store area in grid (fails if grid has too many areas for its cell type)
   int fillId = (windowArea ? windowArea->id() : 0);
 
-  grid_.fill(row, col, row1, col1, fillId);
+  if (! grid().fill(row, col, row1, col1, fillId))
+    std::cerr << "Too many areas to add area " << fillId << std::endl;
 
   //------
 
   if (isVisible())
     updatePlacement();
+
+  if (windowArea)
+    endUndoStep();
 }
 
 // remove window area
@@ -218,21 +266,23 @@ void
 CQTileArea::
 removeArea(CQTileWindowArea *area)
 {
+  beginUndoStep();
+
   // remove area
   areas_.erase(area->id());
 
+  area->removeEventFilter(this);
+
+  areaSizeHints_.erase(area->id());
+
   // remove from grid
-  grid_.replace(area->id(), -1);
+  grid().replace(area->id(), -1);
 
   // remove from placement
-  uint np = uint(placementAreas_.size());
-
-  for (uint i = 0; i < np; ++i) {
-    PlacementArea &placementArea = placementAreas_[i];
+  int pid = getPlacementAreaIndex(area->id());
 
-    if (placementArea.areaId == area->id())
-      placementArea.areaId = 0;
-  }
+  if (pid >= 0)
+    layout_.setPlacementAreaId(pid, 0);
 
   // if current area then set new current
   if (currentArea_ == area) {
@@ -241,6 +291,8 @@ removeArea(CQTileWindowArea *area)
     else
       setCurrentArea(nullptr);
   }
+
+  endUndoStep();
 }
 
 // remove window
@@ -252,6 +304,8 @@ removeWindow(CQTileWindow *window)
   auto *area = getWindowArea(window);
   if (! area) return;
 
+  beginUndoStep();
+
   // remove window from area and check if area now empty (if so delete it)
   bool empty = area->removeWindow(window);
 
@@ -272,6 +326,8 @@ removeWindow(CQTileWindow *window)
   if (isVisible())
     updatePlacement();
 
+  endUndoStep();
+
   // notify close
   emit windowClosed(window);
 
@@ -285,6 +341,44 @@ removeWindow(CQTileWindow *window)
   updateTitles();
 }
 
+// start layout change (updates deferred and changes recorded as single undo step)
+void
+CQTileArea::
+beginLayoutChange()
+{
+  if (layoutDepth_++ > 0)
+    return;
+
+  placementPending_  = false;
+  placementExisting_ = true;
+  titlesPending_     = false;
+
+  beginUndoStep();
+}
+
+// end layout change (apply deferred placement and title updates when outermost change
+// ends)
+void
+CQTileArea::
+endLayoutChange()
+{
+  assert(layoutDepth_ > 0);
+
+  if (--layoutDepth_ > 0)
+    return;
+
+  // placement update also updates titles
+  if      (placementPending_)
+    updatePlacement(placementExisting_);
+  else if (titlesPending_)
+    updateTitles();
+
+  placementPending_ = false;
+  titlesPending_    = false;
+
+  endUndoStep();
+}
+
 // calc best position for new area
 void
 CQTileArea::
@@ -293,40 +387,40 @@ calcBestWindowArea(int &row, int &col, int &nrows, int &ncols)
   // if bottom right cell spans multiple rows or columns the steal rows/columns
   bool steal = false;
 
-  if (grid_.ncols() > 1 && grid_.nrows() > 1) {
-    if      (grid_.cell(grid_.nrows() - 1, grid_.ncols() - 1) ==
-             grid_.cell(grid_.nrows() - 1, grid_.ncols() - 2)) {
+  if (grid().ncols() > 1 && grid().nrows() > 1) {
+    if      (grid().cell(grid().nrows() - 1, grid().ncols() - 1) ==
+             grid().cell(grid().nrows() - 1, grid().ncols() - 2)) {
       steal = true;
 
-      row   = grid_.nrows() - 1;
-      col   = grid_.ncols() - 1;
+      row   = grid().nrows() - 1;
+      col   = grid().ncols() - 1;
       nrows = 1;
       ncols = 1;
 
-      while (col > 1 && grid_.cell(grid_.nrows() - 1, col - 1) ==
-                        grid_.cell(grid_.nrows() - 1, col - 2)) {
+      while (col > 1 && grid().cell(grid().nrows() - 1, col - 1) ==
+                        grid().cell(grid().nrows() - 1, col - 2)) {
         --col; ++ncols;
       }
 
       for (int i = 0; i < ncols; ++i)
-        grid_.cell(row, col + i) = -1;
+        grid().setCell(row, col + i, -1);
     }
-    else if (grid_.cell(grid_.nrows() - 1, grid_.ncols() - 1) ==
-             grid_.cell(grid_.nrows() - 2, grid_.ncols() - 1)) {
+    else if (grid().cell(grid().nrows() - 1, grid().ncols() - 1) ==
+             grid().cell(grid().nrows() - 2, grid().ncols() - 1)) {
       steal = true;
 
-      row   = grid_.nrows() - 1;
-      col   = grid_.ncols() - 1;
+      row   = grid().nrows() - 1;
+      col   = grid().ncols() - 1;
       nrows = 1;
       ncols = 1;
 
-      while (row > 1 && grid_.cell(row - 1, grid_.ncols() - 1) ==
-                        grid_.cell(row - 2, grid_.ncols() - 1)) {
+      while (row > 1 && grid().cell(row - 1, grid().ncols() - 1) ==
+                        grid().cell(row - 2, grid().ncols() - 1)) {
         --row; ++nrows;
       }
 
       for (int i = 0; i < nrows; ++i)
-        grid_.cell(row + i, col) = -1;
+        grid().setCell(row + i, col, -1);
     }
   }
 
@@ -336,19 +430,19 @@ calcBestWindowArea(int &row, int &col, int &nrows, int &ncols)
   if (! steal) {
     // Smallest Columns: new grid position is next column with a height of all rows
     // (ensure at least one row if table empty)
-    if (grid_.ncols() <= grid_.nrows()) {
+    if (grid().ncols() <= grid().nrows()) {
       row   = 0;
-      col   = grid_.ncols();
-      nrows = std::max(grid_.nrows(), 1);
+      col   = grid().ncols();
+      nrows = std::max(grid().nrows(), 1);
       ncols = 1;
     }
     // Smallest Rows: new grid position is next row with a width of all columns
     // (ensure at least one column if table empty)
     else {
-      row   = grid_.nrows();
+      row   = grid().nrows();
       col   = 0;
       nrows = 1;
-      ncols = std::max(grid_.ncols(), 1);
+      ncols = std::max(grid().ncols(), 1);
     }
   }
 }
@@ -358,7 +452,7 @@ void
 CQTileArea::
 insertRows(int row, int nrows)
 {
-  grid_.insertRows(row, nrows);
+  grid().insertRows(row, nrows);
 }
 
 // add new columns after specified column
@@ -366,7 +460,7 @@ void
 CQTileArea::
 insertColumns(int col, int ncols)
 {
-  grid_.insertColumns(col, ncols);
+  grid().insertColumns(col, ncols);
 }
 
 // detach window from placement
@@ -374,12 +468,16 @@ void
 CQTileArea::
 detachWindowArea(CQTileWindowArea *window)
 {
+  beginUndoStep();
+
   // reset cells for this window area to zero
-  grid_.replace(window->id(), -1);
+  grid().replace(window->id(), -1);
 
   // update placement
   if (isVisible())
     updatePlacement();
+
+  endUndoStep();
 }
 
 // replace window area with new window area
@@ -387,14 +485,37 @@ void
 CQTileArea::
 replaceWindowArea(CQTileWindowArea *oldArea, CQTileWindowArea *newArea)
 {
+  beginUndoStep();
+
   // reset cells of old area to new area
-  grid_.replace(oldArea->id(), newArea->id());
+  grid().replace(oldArea->id(), newArea->id());
+
+  int pid = getPlacementAreaIndex(oldArea->id());
+
+  // old area not placed so update whole placement
+  if (pid < 0) {
+    updatePlacement();
+
+    endUndoStep();
+
+    return;
+  }
 
-  PlacementArea &placementArea = getPlacementAreaForArea(oldArea);
+  // placement area gets new area (and its size constraints)
+  layout_.setAreaSize(newArea->id(), getLayoutAreaSize(newArea));
 
-  placementArea.areaId = newArea->id();
+  layout_.setPlacementAreaId(pid, newArea->id());
 
-  updatePlacementGeometry(placementArea);
+  // refit layout if new area does not fit placement area
+  if (layout_.isDirty()) {
+    adjustToFit();
+
+    updatePlacementGeometries();
+  }
+  else
+    updatePlacementGeometries(std::vector<int>(1, pid));
+
+  endUndoStep();
 }
 
 // set grid from cell list (for debug)
@@ -402,13 +523,13 @@ void
 CQTileArea::
 setGrid(int nrows, int ncols, const std::vector<int> &cells)
 {
-  grid_.setSize(nrows, ncols);
+  grid().setSize(nrows, ncols);
 
   for (int i = 0; i < nrows*ncols; ++i) {
     int r = i / ncols;
     int c = i % ncols;
 
-    grid_.cell(r, c) = cells[uint(i)];
+    grid().setCell(r, c, cells[uint(i)]);
   }
 
   updatePlacement();
@@ -419,6 +540,13 @@ void
 CQTileArea::
 updatePlacement(bool useExisting)
 {
+  // defer until end of layout change (only uses existing sizes if all updates do)
+  if (layoutDepth_ > 0) {
+    placementPending_  = true;
+    placementExisting_ = (placementExisting_ && useExisting);
+    return;
+  }
+
   // remove empty cells and cleanup duplicate rows and columns
   fillEmptyCells();
 
@@ -441,7 +569,7 @@ updatePlacement(bool useExisting)
   //------
 
   if (CQTileAreaConstants::debug_grid)
-    grid_.print(std::cerr);
+    grid().print(std::cerr);
 }
 
 // expand occupied cells to fill empty ones
@@ -449,7 +577,15 @@ void
 CQTileArea::
 fillEmptyCells()
 {
-  grid_.fillEmptyCells();
+  auto result = grid().fillEmptyCells();
+
+  if (result.failed && CQTileAreaConstants::debug_grid) {
+    std::cerr << "Failed to fill " << result.numEmpty << " empty regions (first " <<
+                 result.row1 << "," << result.col1 << " " <<
+                 result.row2 << "," << result.col2 << ")" << std::endl;
+
+    grid().print(std::cerr);
+  }
 }
 
 // remove duplicate rows and columns to compress grid
@@ -457,8 +593,8 @@ void
 CQTileArea::
 removeDuplicateCells()
 {
-  grid_.removeDuplicateRows();
-  grid_.removeDuplicateCols();
+  grid().removeDuplicateRows();
+  grid().removeDuplicateCols();
 }
 
 // convert logical grid to physical placement (including splitters)
@@ -466,95 +602,23 @@ void
 CQTileArea::
 gridToPlacement(bool useExisting)
 {
-  int ss = splitterSize();
-
-  PlacementAreas placementAreas = placementAreas_;
-
-  placementAreas_.clear();
-
-  CTileGrid grid = grid_;
-
-  for (int r = 0; r < grid.nrows(); ++r) {
-    for (int c = 0; c < grid.ncols(); ++c) {
-      int id = grid.cell(r, c);
-
-      if (id < -1)
-        continue;
-
-      // get extent (nrows, ncols) of area with specified id
-      int nr, nc;
-
-      if (! grid.getRegion(id, r, c, &nr, &nc))
-        continue;
-
-      // clear cells with this id
-      int r2 = r + nr - 1;
-      int c2 = c + nc - 1;
-
-      grid.fill(r, c, r2, c2, -2);
-
-      // get area id
-      int areaId = 0;
-
-      if (id > 0) {
-        auto *area = getAreaForId(id);
-
-        if (area)
-          areaId = area->id();
-        else {
-          std::cerr << "Invalid Area Id " << id << std::endl;
-          //assert(false);
-          continue;
-        }
-      }
+  updateLayoutSizes();
 
-      // create placement area for this area
-      PlacementArea placementArea;
+  // grid cells with no window area are not placed
+  std::vector<int> invalidIds;
 
-      placementArea.place(r, c, nr, nc, areaId);
-
-      // use original size if possible
-      if (useExisting) {
-        int pid = getPlacementAreaIndex(placementAreas, id);
-
-        if (pid >= 0) {
-          PlacementArea &placementArea1 = placementAreas[uint(pid)];
-
-          placementArea.width  = placementArea1.width ;
-          placementArea.height = placementArea1.height;
-
-          if (placementArea.col2() != grid.ncols()) placementArea.width  += ss/2;
-          if (placementArea.col1() != 0           ) placementArea.width  += ss/2;
-          if (placementArea.row2() != grid.nrows()) placementArea.height += ss/2;
-          if (placementArea.row1() != 0           ) placementArea.height += ss/2;
-        }
-        else {
-          if (defWidth_ > 0 && defHeight_ > 0) {
-            placementArea.width  = defWidth_;
-            placementArea.height = defHeight_;
-          }
-          else {
-            placementArea.width  = (grid.ncols() > 1 ? width ()/(grid.ncols() - 1) : width ());
-            placementArea.height = (grid.nrows() > 1 ? height()/(grid.nrows() - 1) : height());
-          }
-        }
-      }
-      else {
-        placementArea.width  = (grid.ncols() > 1 ? width ()/(grid.ncols() - 1) : width ());
-        placementArea.height = (grid.nrows() > 1 ? height()/(grid.nrows() - 1) : height());
-      }
-
-      placementAreas_.push_back(placementArea);
-    }
+  if (! layout_.gridToPlacement(useExisting, &invalidIds)) {
+    for (int id : invalidIds)
+      std::cerr << "Invalid Area Id " << id << std::endl;
   }
 
-  addSplitters();
+  addSplitterWidgets();
 }
 
-// add splitters between placement areas
+// assign splitter widgets to layout splitters
 void
 CQTileArea::
-addSplitters()
+addSplitterWidgets()
 {
   // reset splitter widgets
   for (auto ps : splitterWidgets_) {
@@ -565,360 +629,315 @@ addSplitters()
 
   //---
 
-  hsplitters_.clear();
-  vsplitters_.clear();
-
-  uint np = uint(placementAreas_.size());
-
-  for (uint i = 0; i < np; ++i) {
-    PlacementArea &placementArea = placementAreas_[i];
-
-    int row1 = placementArea.row1();
-    int row2 = placementArea.row2();
-    int col1 = placementArea.col1();
-    int col2 = placementArea.col2();
-
-    // add splitter for each edge
-    if (row1 > 0            ) addHSplitter(int(i), row1, true ); // top
-    if (row2 < grid_.nrows()) addHSplitter(int(i), row2, false); // bottom
-    if (col1 > 0            ) addVSplitter(int(i), col1, true ); // left
-    if (col2 < grid_.ncols()) addVSplitter(int(i), col2, false); // right
-  }
-
-  //------
-
-  combineTouchingSplitters();
-
-  //------
-
-  // ensure no intersect of horizontal splitters with vertical ones
-  for (RowHSplitterArray::iterator p = hsplitters_.begin(); p != hsplitters_.end(); ++p) {
-    int row = (*p).first;
-
-    HSplitterArray &hsplitters = (*p).second;
-
-    uint ns = uint(hsplitters.size());
-
-    for (uint i = 0; i < ns; ++i) {
-      HSplitter &hsplitter = hsplitters[i];
+  for (RowHSplitterArray::iterator p = hsplitters().begin(); p != hsplitters().end(); ++p) {
+    HSplitterArray &splitters = (*p).second;
 
-      intersectVSplitter(row, hsplitter);
-    }
+    for (uint i = 0; i < splitters.size(); ++i)
+      splitters[i].splitterId = (! paintSplitters_ ?
+        createSplitterWidget(Qt::Horizontal, (*p).first, int(i)) : -1);
   }
 
-  //------
-
-  for (RowHSplitterArray::iterator p = hsplitters_.begin(); p != hsplitters_.end(); ++p) {
-    HSplitterArray &hsplitters = (*p).second;
+  for (ColVSplitterArray::iterator p = vsplitters().begin(); p != vsplitters().end(); ++p) {
+    VSplitterArray &splitters = (*p).second;
 
-    for (uint i = 0; i < hsplitters.size(); ++i)
-      hsplitters[i].splitterId = createSplitterWidget(Qt::Horizontal, (*p).first, int(i));
+    for (uint i = 0; i < splitters.size(); ++i)
+      splitters[i].splitterId = (! paintSplitters_ ?
+        createSplitterWidget(Qt::Vertical, (*p).first, int(i)) : -1);
   }
 
-  for (ColVSplitterArray::iterator p = vsplitters_.begin(); p != vsplitters_.end(); ++p) {
-    VSplitterArray &vsplitters = (*p).second;
-
-    for (uint i = 0; i < vsplitters.size(); ++i)
-      vsplitters[i].splitterId = createSplitterWidget(Qt::Vertical, (*p).first, int(i));
-  }
+  updateAreaSplitters();
 }
 
-// combine touching splitters
+// update all area geometries from placement data
 void
 CQTileArea::
-combineTouchingSplitters()
+updatePlacementGeometries()
 {
-  // combine touching splitters
-  for (int r = 0; r < grid_.nrows(); ++r) {
-    RowHSplitterArray::iterator p = hsplitters_.find(r);
-    if (p == hsplitters_.end()) continue;
+  beginGeometryUpdate();
 
-    HSplitterArray &splitters = (*p).second;
+  uint np = uint(placementAreas().size());
 
-    bool combine = true;
+  placementIndex_.reset(int(np));
 
-    while (combine) {
-      combine = false;
+  for (uint i = 0; i < np; ++i) {
+    PlacementArea &placementArea = placementAreas()[i];
 
-      uint ns = uint(splitters.size());
+    updatePlacementGeometry(placementArea);
 
-      for (uint i = 0; ! combine && i < ns; ++i) {
-        HSplitter &splitter1 = splitters[i];
+    updatePlacementIndex(int(i));
+  }
 
-        for (uint j = i + 1; ! combine && j < ns; ++j) {
-          HSplitter &splitter2 = splitters[j];
+  updateSplitterGeometries();
 
-          if (splitter2.col1 <= splitter1.col2 && splitter2.col2 >= splitter1.col1) {
-            splitter1.col1 = std::min(splitter1.col1, splitter2.col1);
-            splitter1.col2 = std::max(splitter1.col2, splitter2.col2);
+  endGeometryUpdate();
+}
 
-            std::copy(splitter2.tareas.begin(), splitter2.tareas.end(),
-                      std::inserter(splitter1.tareas, splitter1.tareas.end()));
-            std::copy(splitter2.bareas.begin(), splitter2.bareas.end(),
-                      std::inserter(splitter1.bareas, splitter1.bareas.end()));
+// update area geometries of specified placement areas (moved widgets repaint
+// themselves so area is not repainted)
+void
+CQTileArea::
+updatePlacementGeometries(const std::vector<int> &pids)
+{
+  if (pids.empty())
+    return;
 
-            for (uint k = j + 1; k < ns; ++k)
-              splitters[k - 1] = splitters[k];
+  beginGeometryUpdate(/*repaint*/false);
 
-            splitters.pop_back();
+  for (int pid : pids) {
+    updatePlacementGeometry(placementAreas()[uint(pid)]);
 
-            combine = true;
-          }
-        }
-      }
-    }
+    updatePlacementIndex(pid);
   }
 
-  for (int c = 0; c < grid_.ncols(); ++c) {
-    ColVSplitterArray::iterator p = vsplitters_.find(c);
-    if (p == vsplitters_.end()) continue;
-
-    VSplitterArray &splitters = (*p).second;
+  updateSplitterGeometries(pids);
 
-    bool combine = true;
+  endGeometryUpdate();
+}
 
-    while (combine) {
-      combine = false;
+// update area geometry from placement data (only set if changed, reparented area is
+// shown at end of geometry update)
+void
+CQTileArea::
+updatePlacementGeometry(PlacementArea &placementArea)
+{
+  auto *area = getAreaForId(placementArea.areaId);
 
-      uint ns = uint(splitters.size());
+  if (! area)
+    return;
 
-      for (uint i = 0; ! combine && i < ns; ++i) {
-        VSplitter &splitter1 = splitters[i];
+  QRect rect(placementArea.x1(), placementArea.y1(), placementArea.width, placementArea.height);
 
-        for (uint j = i + 1; ! combine && j < ns; ++j) {
-          VSplitter &splitter2 = splitters[j];
+  bool reparent = (area->parentWidget() != this ||
+                   (area->windowFlags() & Qt::FramelessWindowHint));
 
-          if (splitter2.row1 <= splitter1.row2 && splitter2.row2 >= splitter1.row1) {
-            splitter1.row1 = std::min(splitter1.row1, splitter2.row1);
-            splitter1.row2 = std::max(splitter1.row2, splitter2.row2);
+  if (reparent) {
+    area->setParent(this, CQTileAreaConstants::normalFlags);
 
-            std::copy(splitter2.lareas.begin(), splitter2.lareas.end(),
-                      std::inserter(splitter1.lareas, splitter1.lareas.end()));
-            std::copy(splitter2.rareas.begin(), splitter2.rareas.end(),
-                      std::inserter(splitter1.rareas, splitter1.rareas.end()));
+    showAreas_.push_back(area);
+  }
 
-            for (uint k = j + 1; k < ns; ++k)
-              splitters[k - 1] = splitters[k];
+  if (reparent || area->geometry() != rect)
+    area->setGeometry(rect);
+}
 
-            splitters.pop_back();
+// update drop target rectangle of placement area in placement index
+// (edges are inclusive so point on right/bottom edge is inside)
+void
+CQTileArea::
+updatePlacementIndex(int pid)
+{
+  const PlacementArea &placementArea = placementAreas()[uint(pid)];
 
-            combine = true;
-          }
-        }
-      }
-    }
-  }
+  placementIndex_.setRect(pid, CTileRectIndex::Rect(placementArea.x1(), placementArea.y1(),
+                                                    placementArea.width + 1,
+                                                    placementArea.height + 1));
 }
 
-// update all area geometries from placement data
+// update all splitter rectangles from layout splitters (rectangles are only
+// calculated when placement changes)
 void
 CQTileArea::
-updatePlacementGeometries()
+updateSplitterGeometries()
 {
-  uint np = uint(placementAreas_.size());
+  splittersPending_ = true;
 
-  for (uint i = 0; i < np; ++i) {
-    PlacementArea &placementArea = placementAreas_[i];
+  pendingSplitters_.clear();
 
-    updatePlacementGeometry(placementArea);
-  }
+  if (geometryDepth_ == 0)
+    updatePendingSplitters();
 }
 
-// update area geometry from placement data
+// update rectangles of splitters next to changed placement areas
 void
 CQTileArea::
-updatePlacementGeometry(PlacementArea &placementArea)
+updateSplitterGeometries(const std::vector<int> &pids)
 {
-  auto *area = getAreaForId(placementArea.areaId);
-
-  if (area) {
-    bool reparent = (area->parentWidget() != this ||
-                     (area->windowFlags() & Qt::FramelessWindowHint));
+  if (splittersPending_)
+    return;
 
-    if (reparent)
-      area->setParent(this, CQTileAreaConstants::normalFlags);
+  for (int pid : pids) {
+    if (uint(pid) >= areaSplitters_.size()) {
+      updateSplitterGeometries();
+      return;
+    }
 
-    area->move  (placementArea.x1 (), placementArea.y1  ());
-    area->resize(placementArea.width, placementArea.height);
+    const SplitterIds &areaInds = areaSplitters_[uint(pid)];
 
-    if (reparent)
-      area->show();
+    pendingSplitters_.insert(pendingSplitters_.end(), areaInds.begin(), areaInds.end());
   }
+
+  if (geometryDepth_ == 0)
+    updatePendingSplitters();
 }
 
-// add horizontal splitter to placement area row
+// update splitters collected during geometry update (each splitter once)
 void
 CQTileArea::
-addHSplitter(int i, int row, bool top)
+updatePendingSplitters()
 {
-  PlacementArea &placementArea = placementAreas_[uint(i)];
+  if (splittersPending_) {
+    int n = int(splitterRects_.size());
 
-  int ss = splitterSize();
+    for (int i = 0; i < n; ++i)
+      updateSplitterGeometry(i);
+  }
+  else {
+    std::sort(pendingSplitters_.begin(), pendingSplitters_.end());
 
-  // adjust size for splitter
-  if (top) { placementArea.y      += ss/2; placementArea.height -= ss/2; }
-  else     { placementArea.height -= ss/2; }
+    pendingSplitters_.erase(std::unique(pendingSplitters_.begin(), pendingSplitters_.end()),
+                            pendingSplitters_.end());
 
-  // get column range
-  int col1 = placementArea.col1();
-  int col2 = placementArea.col2();
+    for (int i : pendingSplitters_) {
+      if (uint(i) < splitterRects_.size())
+        updateSplitterGeometry(i);
+    }
+  }
 
-  // check overlap with existing splitters for this row
-  int is;
+  splittersPending_ = false;
 
-  if (getHSplitter(row, col1, col2, is)) {
-    HSplitter &splitter = hsplitters_[row][uint(is)];
+  pendingSplitters_.clear();
+}
 
-    // handle exact overlap
-    if (col1 == splitter.col1 && col2 == splitter.col2) {
-      if (top)
-        splitter.bareas.insert(i);
-      else
-        splitter.tareas.insert(i);
+// update cached rectangle of splitter from its layout splitter (and set widget geometry
+// or repaint old and new rectangle if changed)
+void
+CQTileArea::
+updateSplitterGeometry(int i)
+{
+  SplitterRect &splitterRect = splitterRects_[uint(i)];
 
-      return;
-    }
+  QRect rect;
 
-    // handle join
-    splitter.col1 = std::min(splitter.col1, col1);
-    splitter.col2 = std::max(splitter.col2, col2);
+  if (splitterRect.orient == Qt::Horizontal) {
+    RowHSplitterArray::const_iterator p = hsplitters().find(splitterRect.pos);
+    if (p == hsplitters().end() || uint(splitterRect.ind) >= (*p).second.size()) return;
 
-    if (top)
-      splitter.bareas.insert(i);
-    else
-      splitter.tareas.insert(i);
+    rect = getHSplitterRect((*p).second[uint(splitterRect.ind)]);
+  }
+  else {
+    ColVSplitterArray::const_iterator p = vsplitters().find(splitterRect.pos);
+    if (p == vsplitters().end() || uint(splitterRect.ind) >= (*p).second.size()) return;
+
+    rect = getVSplitterRect((*p).second[uint(splitterRect.ind)]);
+  }
 
+  if (rect == splitterRect.rect)
     return;
+
+  if (paintSplitters_) {
+    update(splitterRect.rect);
+    update(rect);
   }
 
-  HSplitter splitter;
+  splitterRect.rect = rect;
 
-  splitter.col1 = col1;
-  splitter.col2 = col2;
+  splitterIndex_.setRect(i, CTileRectIndex::Rect(rect.x(), rect.y(), rect.width(), rect.height()));
 
-  if (top)
-    splitter.bareas.insert(i);
-  else
-    splitter.tareas.insert(i);
+  auto *splitterWidget = getSplitterWidget(splitterRect.widgetId);
 
-  hsplitters_[row].push_back(splitter);
+  if (splitterWidget)
+    splitterWidget->setGeometry(rect);
 }
 
-// add vertical splitter to placement area column
+// update splitter list (key and widget of each layout splitter) and splitters next to
+// (above/below or left/right of) each placement area. Rectangles are calculated at end
+// of next geometry update
 void
 CQTileArea::
-addVSplitter(int i, int col, bool left)
+updateAreaSplitters()
 {
-  PlacementArea &placementArea = placementAreas_[uint(i)];
+  splitterRects_.clear();
 
-  int ss = splitterSize();
+  areaSplitters_.assign(placementAreas().size(), SplitterIds());
 
-  // adjust size for splitter
-  if (left) { placementArea.x     += ss/2; placementArea.width -= ss/2; }
-  else      { placementArea.width -= ss/2; }
+  auto addSplitter = [&](Qt::Orientation orient, int pos, int ind, int widgetId,
+                         const AreaSet &areas1, const AreaSet &areas2) {
+    int i = int(splitterRects_.size());
 
-  // get row range
-  int row1 = placementArea.row1();
-  int row2 = placementArea.row2();
+    SplitterRect splitterRect;
 
-  // check overlap with existing splitters for this column
-  int is;
+    splitterRect.orient   = orient;
+    splitterRect.pos      = pos;
+    splitterRect.ind      = ind;
+    splitterRect.widgetId = widgetId;
 
-  if (getVSplitter(col, row1, row2, is)) {
-    VSplitter &splitter = vsplitters_[col][uint(is)];
-
-    // handle exact overlap
-    if (row1 == splitter.row1 && row2 == splitter.row2) {
-      if (left)
-        splitter.rareas.insert(i);
-      else
-        splitter.lareas.insert(i);
+    splitterRects_.push_back(splitterRect);
 
-      return;
+    for (const AreaSet *areas : {&areas1, &areas2}) {
+      for (int pid : *areas) {
+        if (uint(pid) < areaSplitters_.size())
+          areaSplitters_[uint(pid)].push_back(i);
+      }
     }
+  };
 
-    // handle join
-    splitter.row1 = std::min(splitter.row1, row1);
-    splitter.row2 = std::max(splitter.row2, row2);
+  for (const auto &ps : hsplitters()) {
+    const HSplitterArray &splitters = ps.second;
 
-    if (left)
-      splitter.rareas.insert(i);
-    else
-      splitter.lareas.insert(i);
+    for (uint i = 0; i < splitters.size(); ++i)
+      addSplitter(Qt::Horizontal, ps.first, int(i), splitters[i].splitterId,
+                  splitters[i].tareas, splitters[i].bareas);
+  }
 
-    return;
+  for (const auto &ps : vsplitters()) {
+    const VSplitterArray &splitters = ps.second;
+
+    for (uint i = 0; i < splitters.size(); ++i)
+      addSplitter(Qt::Vertical, ps.first, int(i), splitters[i].splitterId,
+                  splitters[i].lareas, splitters[i].rareas);
   }
 
-  VSplitter splitter;
+  splitterIndex_.reset(int(splitterRects_.size()));
 
-  splitter.row1 = row1;
-  splitter.row2 = row2;
+  // all splitter rectangles are set at end of next geometry update
+  splittersPending_ = true;
 
-  if (left)
-    splitter.rareas.insert(i);
-  else
-    splitter.lareas.insert(i);
+  pendingSplitters_.clear();
+
+  // splitters changed so no hover or pressed splitter (an in progress drag is
+  // ended on mouse release)
+  splitterMouse_.hover   = -1;
+  splitterMouse_.pressed = -1;
 
-  vsplitters_[col].push_back(splitter);
+  if (paintSplitters_)
+    unsetCursor();
 }
 
-// check for vertical and horizontal splitter intersection
+// start geometry update (no intermediate repaints until end of outermost update)
 void
 CQTileArea::
-intersectVSplitter(int row, const HSplitter &hsplitter)
+beginGeometryUpdate(bool repaint)
 {
-  for (ColVSplitterArray::iterator p = vsplitters_.begin(); p != vsplitters_.end(); ++p) {
-    std::vector<VSplitter> newVSplitters;
-
-    int col = (*p).first;
-
-    if (col <= hsplitter.col1 || col >= hsplitter.col2) continue;
-
-    VSplitterArray &vsplitters = (*p).second;
-
-    uint ns = uint(vsplitters.size());
-
-    for (uint i = 0; i < ns; ++i) {
-      VSplitter &vsplitter = vsplitters[i];
-
-      if (row <= vsplitter.row1 || row >= vsplitter.row2) continue;
-
-      // split
-      AreaSet lareas = vsplitter.lareas;
-      AreaSet rareas = vsplitter.rareas;
-
-      vsplitter.lareas.clear();
-      vsplitter.rareas.clear();
-
-      VSplitter vsplitter1 = vsplitter;
+  if (geometryDepth_++ > 0)
+    return;
 
-      vsplitter .row2 = row;
-      vsplitter1.row1 = row;
+  geometryUpdates_ = (repaint && updatesEnabled());
 
-      for (AreaSet::iterator pl = lareas.begin(); pl != lareas.end(); ++pl) {
-        const PlacementArea &placementArea = placementAreas_[uint(*pl)];
+  if (geometryUpdates_)
+    setUpdatesEnabled(false);
+}
 
-        if (placementArea.row1() < row)
-          vsplitter .lareas.insert(*pl);
-        else
-          vsplitter1.lareas.insert(*pl);
-      }
+// end geometry update (shows reparented areas, moves splitters and re-enables updates
+// which repaints area once)
+void
+CQTileArea::
+endGeometryUpdate()
+{
+  if (--geometryDepth_ > 0)
+    return;
 
-      for (AreaSet::iterator pr = rareas.begin(); pr != rareas.end(); ++pr) {
-        const PlacementArea &placementArea = placementAreas_[uint(*pr)];
+  for (auto &area : showAreas_) {
+    if (area)
+      area->show();
+  }
 
-        if (placementArea.row1() < row)
-          vsplitter .rareas.insert(*pr);
-        else
-          vsplitter1.rareas.insert(*pr);
-      }
+  showAreas_.clear();
 
-      newVSplitters.push_back(vsplitter1);
-    }
+  // update splitters of changed placement areas
+  updatePendingSplitters();
 
-    for (uint i = 0; i < newVSplitters.size(); ++i)
-      vsplitters_[col].push_back(newVSplitters[i]);
-  }
+  if (geometryUpdates_)
+    setUpdatesEnabled(true);
 }
 
 // adjust placement area sizes to fit new larger/smaller widget geometry
@@ -926,387 +945,102 @@ void
 CQTileArea::
 adjustToFit()
 {
-  uint np = uint(placementAreas_.size());
-
-  std::vector<bool> sized(np);
+  updateLayoutSizes();
 
-  int b  = border();
-  int ss = splitterSize();
-
-  //------
+  layout_.adjustToFit();
+}
 
-  // adjust areas to fit width
-  int w = width();
+// update layout engine size and area size constraints from widgets
+void
+CQTileArea::
+updateLayoutSizes()
+{
+  layout_.setSize(width(), height());
 
-  std::fill(sized.begin(), sized.end(), false);
+  layout_.setMinSize(CQTileAreaConstants::min_size);
 
-  for (int r = 0; r < grid_.nrows(); ++r) {
-    std::vector<int> pids;
+  CTileLayout::AreaSizes sizes;
 
-    // get list of placement area ids on this row
-    int c = 0;
+  for (WindowAreas::const_iterator p = areas_.begin(); p != areas_.end(); ++p)
+    sizes[(*p).first] = getLayoutAreaSize((*p).second);
 
-    while (c < grid_.ncols()) {
-      int cell = grid_.cell(r, c);
+  layout_.setAreaSizes(sizes);
+}
 
-      ++c;
+// get layout size constraints of window area from its size hints
+CTileLayout::AreaSize
+CQTileArea::
+getLayoutAreaSize(CQTileWindowArea *area) const
+{
+  const AreaSizeHints &sizeHints = getAreaSizeHints(area);
 
-      while (c < grid_.ncols() && grid_.cell(r, c) == cell)
-        ++c;
+  const QSize &minSize = sizeHints.minSize;
+  const QSize &maxSize = sizeHints.maxSize;
 
-      int pid = getPlacementAreaIndex(cell);
+  int maxWidth  = (maxSize.width () < QWIDGETSIZE_MAX ? maxSize.width () : INT_MAX);
+  int maxHeight = (maxSize.height() < QWIDGETSIZE_MAX ? maxSize.height() : INT_MAX);
 
-      if (pid >= 0)
-        pids.push_back(pid);
-    }
+  return CTileLayout::AreaSize(CTileLayout::Size(minSize.width(), minSize.height()),
+                               CTileLayout::Size(maxWidth, maxHeight));
+}
 
-    // resize placement areas on row
-    int x1 = b;
+// get size hints of window area (only queried from widget if not cached)
+const CQTileArea::AreaSizeHints &
+CQTileArea::
+getAreaSizeHints(CQTileWindowArea *area) const
+{
+  AreaSizeHintsMap::iterator p = areaSizeHints_.find(area->id());
 
-    uint i2 = 0;
+  if (p == areaSizeHints_.end()) {
+    AreaSizeHints sizeHints;
 
-    while (i2 < pids.size()) {
-      // get range to next sized width column
-      uint i1 = i2;
+    sizeHints.minSize  = area->minimumSizeHint();
+    sizeHints.prefSize = area->sizeHint();
+    sizeHints.maxSize  = area->maximumSize();
 
-      while (i2 < pids.size() && ! sized[uint(pids[i2])])
-        ++i2;
+    p = areaSizeHints_.insert(p, AreaSizeHintsMap::value_type(area->id(), sizeHints));
+  }
 
-      int ns = std::max(int(i2 - i1), 1);
+  return (*p).second;
+}
 
-      //---
+// invalidate cached size hints of window area (requeried on next layout update)
+void
+CQTileArea::
+invalidateAreaSizeHints(CQTileWindowArea *area)
+{
+  areaSizeHints_.erase(area->id());
+}
 
-      // calc start and end of range and width to fill
-      int x2;
+// update all area title bars
+void
+CQTileArea::
+updateTitles()
+{
+  // defer until end of layout change
+  if (layoutDepth_ > 0) {
+    titlesPending_ = true;
+    return;
+  }
 
-      if (i2 < pids.size())
-        x2 = placementAreas_[uint(pids[i2])].x1() - ss;
-      else
-        x2 = w - b;
+  updateMenuBar();
 
-      int w1 = x2 - x1 - (ns - 1)*ss;
+  for (WindowAreas::iterator p = areas_.begin(); p != areas_.end(); ++p) {
+    auto *area = (*p).second;
 
-      for (uint i = i1; i < i2; ++i) {
-        PlacementArea &placementArea = placementAreas_[uint(pids[i])];
+    area->updateTitle();
+  }
+}
 
-        w1 -= placementArea.width;
-      }
+// update menu bar
+void
+CQTileArea::
+updateMenuBar()
+{
+  bool hasControls = isMaximized();
 
-      // ensure we have not invalidated the row
-      int  dw    = (w1 > 0 ? (w1 + ns - 1)/ns : (w1 - ns + 1)/ns);
-      bool reset = false;
-
-      for (uint i = i1; i < i2; ++i) {
-        PlacementArea &placementArea = placementAreas_[uint(pids[i])];
-
-        auto *area = getAreaForId(placementArea.areaId);
-
-        int min_size = (area ? area->minimumSizeHint().width() :
-                               CQTileAreaConstants::min_size + ss);
-
-        if (placementArea.width + dw < min_size)
-          reset = true;
-      }
-
-      if (reset) {
-        int reset_width = 100;
-
-        for (uint i = i1; i < i2; ++i) {
-           PlacementArea &placementArea = placementAreas_[uint(pids[i])];
-
-           placementArea.width = reset_width;
-        }
-
-        w1 = x2 - x1 - (ns - 1)*ss - ns*reset_width;
-      }
-
-      //---
-
-      // share fill between columns
-      for (uint i = i1; i < i2; ++i) {
-        PlacementArea &placementArea = placementAreas_[uint(pids[i])];
-
-        // adjust width
-        int dw = w1/ns;
-
-        placementArea.x      = x1;
-        placementArea.width += dw;
-
-        sized[uint(pids[i])] = true;
-
-        w1 -= dw;
-
-        --ns;
-
-        x1 = placementArea.x2() + ss;
-      }
-
-      //---
-
-      // move to next non sized column
-      i1 = i2++;
-
-      while (i2 < pids.size() && sized[uint(pids[i2])])
-        ++i2;
-
-      if (i2 < pids.size()) {
-        PlacementArea &placementArea = placementAreas_[uint(pids[i2 - 1])];
-
-        x1 = placementArea.x2() + ss;
-      }
-    }
-  }
-
-  //------
-
-  // adjust areas to fit height
-  int h = height();
-
-  std::fill(sized.begin(), sized.end(), false);
-
-  for (int c = 0; c < grid_.ncols(); ++c) {
-    std::vector<int> pids;
-
-    // get list of placement area ids on this column
-    int r = 0;
-
-    while (r < grid_.nrows()) {
-      int cell = grid_.cell(r, c);
-
-      ++r;
-
-      while (r < grid_.nrows() && grid_.cell(r, c) == cell)
-        ++r;
-
-      int pid = getPlacementAreaIndex(cell);
-
-      if (pid >= 0)
-        pids.push_back(pid);
-    }
-
-    // resize placement areas on column
-    int y1 = b;
-
-    uint i2 = 0;
-
-    while (i2 < pids.size()) {
-      // get range to next sized width row
-      uint i1 = i2;
-
-      while (i2 < pids.size() && ! sized[uint(pids[i2])])
-        ++i2;
-
-      int ns = std::max(int(i2 - i1), 1);
-
-      //---
-
-      // calc start and end of range and height to fill
-      int y2;
-
-      if (i2 < pids.size())
-        y2 = placementAreas_[uint(pids[i2])].y1() - ss;
-      else
-        y2 = h - b;
-
-      int h1 = y2 - y1 - (ns - 1)*ss;
-
-      for (uint i = i1; i < i2; ++i) {
-        PlacementArea &placementArea = placementAreas_[uint(pids[i])];
-
-        h1 -= placementArea.height;
-      }
-
-      // ensure we have not invalidated the column
-      int  dh    = (h1 > 0 ? (h1 + ns - 1)/ns : (h1 - ns + 1)/ns);
-      bool reset = false;
-
-      for (uint i = i1; i < i2; ++i) {
-        PlacementArea &placementArea = placementAreas_[uint(pids[i])];
-
-        auto *area = getAreaForId(placementArea.areaId);
-
-        int min_size = (area ? area->minimumSizeHint().height() :
-                               CQTileAreaConstants::min_size + ss);
-
-        if (placementArea.height + dh < min_size)
-          reset = true;
-      }
-
-      if (reset) {
-        int reset_height = 100;
-
-        for (uint i = i1; i < i2; ++i) {
-           PlacementArea &placementArea = placementAreas_[uint(pids[i])];
-
-           placementArea.height = reset_height;
-        }
-
-        h1 = y2 - y1 - (ns - 1)*ss - ns*reset_height;
-      }
-
-      //---
-
-      // share fill between rows
-      for (uint i = i1; i < i2; ++i) {
-        PlacementArea &placementArea = placementAreas_[uint(pids[i])];
-
-        // adjust height
-        int dh = h1/ns;
-
-        placementArea.y       = y1;
-        placementArea.height += dh;
-
-        sized[uint(pids[i])] = true;
-
-        h1 -= dh;
-
-        --ns;
-
-        y1 = placementArea.y2() + ss;
-      }
-
-      //---
-
-      // move to next non sized row
-      i1 = i2++;
-
-      while (i2 < pids.size() && sized[uint(pids[i2])])
-        ++i2;
-
-      if (i2 < pids.size()) {
-        PlacementArea &placementArea = placementAreas_[uint(pids[i2 - 1])];
-
-        y1 = placementArea.y2() + ss;
-      }
-    }
-  }
-
-  //-------
-
-  for (int r = 0; r < grid_.nrows(); ++r) {
-    for (int c = 0; c < grid_.ncols(); ++c) {
-      int cell = grid_.cell(r, c);
-
-      int pid = getPlacementAreaIndex(cell);
-
-      if (pid >= 0) {
-        PlacementArea &placementArea = placementAreas_[uint(pid)];
-
-        adjustSameWidthPlacements (placementArea);
-        adjustSameHeightPlacements(placementArea);
-      }
-    }
-  }
-}
-
-// ensure all cells to left and right of vertical splitter have same x/width
-void
-CQTileArea::
-adjustSameWidthPlacements(PlacementArea &area)
-{
-  int b = border();
-
-  int is;
-
-  // right splitters
-  if (getVSplitter(area.col1(), area.row1(), area.row2(), is)) {
-    VSplitter &splitter = vsplitters_[area.col1()][uint(is)];
-
-    for (AreaSet::iterator pr = splitter.rareas.begin(); pr != splitter.rareas.end(); ++pr) {
-      int pid = *pr;
-
-      PlacementArea &area1 = placementAreas_[uint(pid)];
-
-      if (area1.x1() != area.x1())
-        area1.x = area.x;
-    }
-  }
-
-  // left splitters
-  if (getVSplitter(area.col2(), area.row1(), area.row2(), is)) {
-    VSplitter &splitter = vsplitters_[area.col2()][uint(is)];
-
-    for (AreaSet::iterator pl = splitter.lareas.begin(); pl != splitter.lareas.end(); ++pl) {
-      int pid = *pl;
-
-      PlacementArea &area1 = placementAreas_[uint(pid)];
-
-      if (area1.x2() != area.x2()) {
-        area1.width = area.x + area.width - area1.x;
-      }
-    }
-  }
-
-  if (area.col2() == grid_.ncols())
-    area.width = width() - b - area.x;
-}
-
-// ensure all cells above and below horizontal splitter have same y/height
-void
-CQTileArea::
-adjustSameHeightPlacements(PlacementArea &area)
-{
-  int b = border();
-
-  int is;
-
-  // above splitters
-  if (getHSplitter(area.row1(), area.col1(), area.col2(), is)) {
-    HSplitter &splitter = hsplitters_[area.row1()][uint(is)];
-
-    for (AreaSet::iterator pb = splitter.bareas.begin(); pb != splitter.bareas.end(); ++pb) {
-      int pid = *pb;
-
-      PlacementArea &area1 = placementAreas_[uint(pid)];
-
-      if (area1.y1() != area.y1()) {
-        area1.y = area.y;
-      }
-    }
-  }
-
-  // below splitters
-  if (getHSplitter(area.row2(), area.col1(), area.col2(), is)) {
-    HSplitter &splitter = hsplitters_[area.row2()][uint(is)];
-
-    for (AreaSet::iterator pt = splitter.tareas.begin(); pt != splitter.tareas.end(); ++pt) {
-      int pid = *pt;
-
-      PlacementArea &area1 = placementAreas_[uint(pid)];
-
-      if (area1.y2() != area.y2()) {
-        area1.height = area.y + area.height - area1.y;
-      }
-    }
-  }
-
-  if (area.row2() == grid_.nrows())
-    area.height = height() - b - area.y;
-}
-
-// update all area title bars
-void
-CQTileArea::
-updateTitles()
-{
-  updateMenuBar();
-
-  for (WindowAreas::iterator p = areas_.begin(); p != areas_.end(); ++p) {
-    auto *area = (*p).second;
-
-    area->updateTitle();
-  }
-}
-
-// update menu bar
-void
-CQTileArea::
-updateMenuBar()
-{
-  bool hasControls = isMaximized();
-
-  if (hasControls != hasControls_) {
-    hasControls_ = hasControls;
+  if (hasControls != hasControls_) {
+    hasControls_ = hasControls;
 
     if (hasControls_ && menuIcon_.isNull()) {
       menuIcon_     = new CQTileAreaMenuIcon(this);
@@ -1456,7 +1190,7 @@ bool
 CQTileArea::
 isFullScreen() const
 {
-  return grid_.isSingleCell();
+  return grid().isSingleCell();
 }
 
 // get number of windows
@@ -1499,7 +1233,7 @@ getPlacementAreaForArea(CQTileWindowArea *area)
 {
   int pid = getPlacementAreaIndex(area->id());
 
-  return placementAreas_[uint(pid)];
+  return placementAreas()[uint(pid)];
 }
 
 // get array index of placement area of specified id
@@ -1507,25 +1241,7 @@ int
 CQTileArea::
 getPlacementAreaIndex(int id) const
 {
-  return getPlacementAreaIndex(placementAreas_, id);
-}
-
-// get array index of placement area of specified id
-int
-CQTileArea::
-getPlacementAreaIndex(const PlacementAreas &placementAreas, int id) const
-{
-  uint np = uint(placementAreas.size());
-
-  for (uint i = 0; i < np; ++i) {
-    const PlacementArea &placementArea = placementAreas[i];
-
-    // check for id match of area
-    if (placementArea.areaId == id)
-      return int(i);
-  }
-
-  return -1;
+  return layout_.getPlacementAreaIndex(id);
 }
 
 // get array at specified row, column
@@ -1533,129 +1249,24 @@ CQTileWindowArea *
 CQTileArea::
 getAreaAt(int row, int col) const
 {
-  int cell = grid_.cell(row, col);
+  int cell = grid().cell(row, col);
 
   int ind = getPlacementAreaIndex(cell);
 
   if (ind >= 0)
-    return getAreaForId(placementAreas_[uint(ind)].areaId);
+    return getAreaForId(placementAreas()[uint(ind)].areaId);
   else
     return nullptr;
 }
 
-// get horizontal splitter at specified row and column range (index returned if found)
-bool
-CQTileArea::
-getHSplitter(int row, int col1, int col2, int &is)
-{
-  is = -1;
-
-  RowHSplitterArray::iterator p = hsplitters_.find(row);
-
-  if (p == hsplitters_.end())
-    return false;
-
-  int il = 0;
-
-  HSplitterArray &splitters = (*p).second;
-
-  uint ns = uint(splitters.size());
-
-  for (uint i = 0; i < ns; ++i) {
-    HSplitter &splitter1 = splitters[i];
-
-    if (col1 > splitter1.col2 || col2 < splitter1.col1) continue;
-
-    if (col1 == splitter1.col1 && col2 == splitter1.col2) {
-      is = int(i);
-      return true;
-    }
-
-    int il1 = std::min(col2, splitter1.col2) - std::max(col1, splitter1.col1);
-
-    if (is < 0 || il1 > il) {
-      is = int(i);
-      il = il1;
-    }
-  }
-
-  return (is >= 0);
-}
-
-// get vertical splitter at specified column and row range (index returned if found)
-bool
-CQTileArea::
-getVSplitter(int col, int row1, int row2, int &is)
-{
-  is = -1;
-
-  ColVSplitterArray::iterator p = vsplitters_.find(col);
-
-  if (p == vsplitters_.end())
-    return false;
-
-  int il = 0;
-
-  VSplitterArray &splitters = (*p).second;
-
-  uint ns = uint(splitters.size());
-
-  for (uint i = 0; i < ns; ++i) {
-    VSplitter &splitter1 = splitters[i];
-
-    if (row1 > splitter1.row2 || row2 < splitter1.row1) continue;
-
-    if (row1 == splitter1.row1 && row2 == splitter1.row2) {
-      is = int(i);
-      return true;
-    }
-
-    int il1 = std::min(row2, splitter1.row2) - std::max(row1, splitter1.row1);
-
-    if (is < 0 || il1 > il) {
-      is = int(i);
-      il = il1;
-    }
-  }
-
-  return (is >= 0);
-}
-
 // get bounding box of horizontal specified splitter
 QRect
 CQTileArea::
 getHSplitterRect(const HSplitter &splitter) const
 {
-  int ss = splitterSize();
-
-  int x1 = INT_MAX, x2 = INT_MIN, yt = INT_MIN, yb = INT_MAX;
-
-  for (AreaSet::const_iterator pt = splitter.tareas.begin(); pt != splitter.tareas.end(); ++pt) {
-    int pid = *pt;
-
-    const PlacementArea &placementArea = placementAreas_[uint(pid)];
-
-    yt = std::max(yt, placementArea.y2());
-
-    x1 = std::min(x1, placementArea.x1());
-    x2 = std::max(x2, placementArea.x2());
-  }
-
-  for (AreaSet::const_iterator pb = splitter.bareas.begin(); pb != splitter.bareas.end(); ++pb) {
-    int pid = *pb;
+  auto rect = layout_.getHSplitterRect(splitter);
 
-    const PlacementArea &placementArea = placementAreas_[uint(pid)];
-
-    yb = std::min(yb, placementArea.y1());
-
-    x1 = std::min(x1, placementArea.x1());
-    x2 = std::max(x2, placementArea.x2());
-  }
-
-  if (yt == INT_MIN) yt = yb - ss;
-  if (yb == INT_MAX) yb = yt + ss;
-
-  return QRect(x1, (yt + yb)/2 - ss/2, x2 - x1, ss);
+  return QRect(rect.x, rect.y, rect.width, rect.height);
 }
 
 // get bounding box of vertical specified splitter
@@ -1663,36 +1274,9 @@ QRect
 CQTileArea::
 getVSplitterRect(const VSplitter &splitter) const
 {
-  int ss = splitterSize();
-
-  int y1 = INT_MAX, y2 = INT_MIN, xl = INT_MIN, xr = INT_MAX;
-
-  for (AreaSet::const_iterator pl = splitter.lareas.begin(); pl != splitter.lareas.end(); ++pl) {
-    int pid = *pl;
-
-    const PlacementArea &placementArea = placementAreas_[uint(pid)];
+  auto rect = layout_.getVSplitterRect(splitter);
 
-    xl = std::max(xl, placementArea.x2());
-
-    y1 = std::min(y1, placementArea.y1());
-    y2 = std::max(y2, placementArea.y2());
-  }
-
-  for (AreaSet::const_iterator pr = splitter.rareas.begin(); pr != splitter.rareas.end(); ++pr) {
-    int pid = *pr;
-
-    const PlacementArea &placementArea = placementAreas_[uint(pid)];
-
-    xr = std::min(xr, placementArea.x1());
-
-    y1 = std::min(y1, placementArea.y1());
-    y2 = std::max(y2, placementArea.y2());
-  }
-
-  if (xl == INT_MIN) xl = xr - ss;
-  if (xr == INT_MAX) xr = xl + ss;
-
-  return QRect((xl + xr)/2 - ss/2, y1, ss, y2 - y1);
+  return QRect(rect.x, rect.y, rect.width, rect.height);
 }
 
 // maximize all areas
@@ -1715,6 +1299,9 @@ maximizeWindows()
   if (areas_.size() == 1)
     return;
 
+  // no intermediate repaints while areas are replaced
+  beginGeometryUpdate();
+
   saveState(restoreState_, false);
 
   // save all windows
@@ -1742,7 +1329,9 @@ maximizeWindows()
 
   // reset
   areas_.clear();
-  grid_ .reset();
+  grid() .reset();
+
+  areaSizeHints_.clear();
 
   currentArea_ = nullptr;
 
@@ -1757,6 +1346,11 @@ maximizeWindows()
   }
 
   addWindowArea(windowArea, 0, 0, 1, 1);
+
+  endGeometryUpdate();
+
+  // old areas are deleted so layout history can not be applied
+  clearUndo();
 }
 
 // restore all windows
@@ -1778,11 +1372,16 @@ restoreWindows()
 
   PlacementState newState = restoreState_;
 
+  // no intermediate repaints while areas are replaced
+  beginGeometryUpdate();
+
   saveState(restoreState_, false);
 
   restoreState(newState);
 
   updateTitles();
+
+  endGeometryUpdate();
 }
 
 // tile all windows
@@ -1799,6 +1398,11 @@ void
 CQTileArea::
 tileWindows()
 {
+  beginUndoStep();
+
+  // no intermediate repaints while areas are replaced
+  beginGeometryUpdate();
+
   // save all windows
   std::vector<CQTileWindow *> windows;
 
@@ -1825,10 +1429,12 @@ tileWindows()
     }
 
     areas_.clear();
+
+    areaSizeHints_.clear();
   }
 
   // reset
-  grid_.reset();
+  grid().reset();
 
   currentArea_ = nullptr;
 
@@ -1838,9 +1444,9 @@ tileWindows()
 
   if (int(windows.size()) % nrows) ++ncols;
 
-  grid_.setSize(nrows, ncols);
+  grid().setSize(nrows, ncols);
 
-  grid_.clear();
+  grid().clear();
 
   // create new areas (one per window)
   int r = 0, c = 0;
@@ -1860,7 +1466,7 @@ tileWindows()
 
     //---
 
-    grid_.cell(r, c) = windowArea->id();
+    grid().setCell(r, c, windowArea->id());
 
     ++c;
 
@@ -1873,6 +1479,14 @@ tileWindows()
 
   // update placement (use new placement sizes)
   updatePlacement(false);
+
+  endGeometryUpdate();
+
+  endUndoStep();
+
+  // old areas are deleted so layout history can not be applied
+  if (newAreas)
+    clearUndo();
 }
 
 // is restore state valid
@@ -1926,57 +1540,207 @@ void
 CQTileArea::
 resizeEvent(QResizeEvent *)
 {
-  adjustToFit();
+  // unsolved layout needs full update (with current area size hints)
+  if (layout_.isDirty()) {
+    adjustToFit();
 
-  updatePlacementGeometries();
+    updatePlacementGeometries();
+
+    return;
+  }
+
+  // map grid edges to new size along changed axis (cached area sizes) and update
+  // changed areas
+  layout_.resize(width(), height(), changedAreas_);
+
+  updatePlacementGeometries(changedAreas_);
 }
 
-// draw splitters
+// draw splitters painted by area (in a single pass, splitter widgets draw themselves)
 void
 CQTileArea::
-paintEvent(QPaintEvent *)
+paintEvent(QPaintEvent *e)
 {
-  // draw horizontal splitters
-  for (RowHSplitterArray::iterator p = hsplitters_.begin(); p != hsplitters_.end(); ++p) {
-    HSplitterArray &splitters = (*p).second;
+  if (! paintSplitters_)
+    return;
 
-    uint ns = uint(splitters.size());
+  QStylePainter ps(this);
 
-    for (uint i = 0; i < ns; ++i) {
-      HSplitter &splitter = splitters[i];
+  int n = int(splitterRects_.size());
 
-      auto rect = getHSplitterRect(splitter);
+  for (int i = 0; i < n; ++i) {
+    const SplitterRect &splitterRect = splitterRects_[uint(i)];
 
-      //if (splitter.splitterId == -1)
-      //  splitter.splitterId = createSplitterWidget(Qt::Horizontal, (*p).first, i);
+    if (! e->rect().intersects(splitterRect.rect))
+      continue;
 
-      auto *splitterWidget = getSplitterWidget(splitter.splitterId);
+    QStyleOption opt;
 
-      if (splitterWidget)
-        splitterWidget->setGeometry(rect);
-    }
-  }
+    opt.initFrom(this);
 
-  // draw vertical splitters
-  for (ColVSplitterArray::iterator p = vsplitters_.begin(); p != vsplitters_.end(); ++p) {
-    VSplitterArray &splitters = (*p).second;
+    opt.rect  = splitterRect.rect;
+    opt.state = (splitterRect.orient == Qt::Horizontal ? QStyle::State_None :
+                                                         QStyle::State_Horizontal);
+
+    if (i == splitterMouse_.pressed)
+      opt.state |= QStyle::State_Sunken;
+
+    if (i == splitterMouse_.hover)
+      opt.state |= QStyle::State_MouseOver;
+
+    ps.drawControl(QStyle::CE_Splitter, opt);
+  }
+}
+
+// handle mouse press (start move of painted splitter under mouse)
+void
+CQTileArea::
+mousePressEvent(QMouseEvent *e)
+{
+  if (! paintSplitters_) {
+    QWidget::mousePressEvent(e);
+    return;
+  }
+
+  if (splitterMouse_.dragging)
+    return;
+
+  int i = splitterIndex_.find(e->pos().x(), e->pos().y());
+
+  if (i < 0)
+    return;
 
-    uint ns = uint(splitters.size());
+  const SplitterRect &splitterRect = splitterRects_[uint(i)];
 
-    for (uint i = 0; i < ns; ++i) {
-      VSplitter &splitter = splitters[i];
+  splitterMouse_.pressed  = i;
+  splitterMouse_.dragging = true;
+  splitterMouse_.pressPos = e->globalPos();
 
-      auto rect = getVSplitterRect(splitter);
+  // record splitter move as single undo step
+  beginUndoStep();
+
+  // plan drag (allowed range and pushed splitters)
+  beginSplitterDrag(splitterRect.orient, splitterRect.pos);
+
+  update(splitterRect.rect);
+}
+
+// handle mouse move (move pressed painted splitter or highlight splitter under mouse)
+void
+CQTileArea::
+mouseMoveEvent(QMouseEvent *e)
+{
+  if (! paintSplitters_) {
+    QWidget::mouseMoveEvent(e);
+    return;
+  }
 
-      //if (splitter.splitterId == -1)
-      //  splitter.splitterId = createSplitterWidget(Qt::Vertical, (*p).first, i);
+  int i = splitterMouse_.pressed;
 
-      auto *splitterWidget = getSplitterWidget(splitter.splitterId);
+  if (i < 0) {
+    setHoverSplitter(splitterIndex_.find(e->pos().x(), e->pos().y()));
+    return;
+  }
+
+  // move by offset from press position (moving back restores pushed splitters)
+  if (uint(i) < splitterRects_.size()) {
+    if (splitterRects_[uint(i)].orient == Qt::Horizontal)
+      dragSplitter(e->globalPos().y() - splitterMouse_.pressPos.y());
+    else
+      dragSplitter(e->globalPos().x() - splitterMouse_.pressPos.x());
+  }
+}
+
+// handle mouse release (end move of painted splitter)
+void
+CQTileArea::
+mouseReleaseEvent(QMouseEvent *e)
+{
+  if (! paintSplitters_) {
+    QWidget::mouseReleaseEvent(e);
+    return;
+  }
+
+  if (! splitterMouse_.dragging)
+    return;
+
+  int i = splitterMouse_.pressed;
+
+  endSplitterMouseDrag();
+
+  if (uint(i) < splitterRects_.size())
+    update(splitterRects_[uint(i)].rect);
+
+  setHoverSplitter(splitterIndex_.find(e->pos().x(), e->pos().y()));
+}
+
+// handle leave (no painted splitter under mouse)
+void
+CQTileArea::
+leaveEvent(QEvent *e)
+{
+  if (paintSplitters_ && splitterMouse_.pressed < 0)
+    setHoverSplitter(-1);
+
+  QWidget::leaveEvent(e);
+}
 
-      if (splitterWidget)
-        splitterWidget->setGeometry(rect);
+// set painted splitter under mouse (redraw old and new splitter and set split cursor)
+void
+CQTileArea::
+setHoverSplitter(int i)
+{
+  if (i == splitterMouse_.hover)
+    return;
+
+  if (uint(splitterMouse_.hover) < splitterRects_.size())
+    update(splitterRects_[uint(splitterMouse_.hover)].rect);
+
+  splitterMouse_.hover = i;
+
+  if (uint(i) < splitterRects_.size()) {
+    const SplitterRect &splitterRect = splitterRects_[uint(i)];
+
+    update(splitterRect.rect);
+
+    setCursor(splitterRect.orient == Qt::Vertical ? Qt::SplitHCursor : Qt::SplitVCursor);
+  }
+  else
+    unsetCursor();
+}
+
+// update layout when size hints of window area change (layout request posted to area
+// when its contents change size constraints)
+bool
+CQTileArea::
+eventFilter(QObject *obj, QEvent *e)
+{
+  if (e->type() == QEvent::LayoutRequest) {
+    auto *area = qobject_cast<CQTileWindowArea *>(obj);
+
+    if (area && areas_.find(area->id()) != areas_.end()) {
+      // only cached size hints of area are invalidated, layout is refit once at end
+      // of layout change or when queued refit runs (requests of multiple areas are
+      // handled by a single refit)
+      invalidateAreaSizeHints(area);
+
+      if (layoutDepth_ > 0)
+        placementPending_ = true;
+      else {
+        refitAreas_.push_back(area->id());
+
+        if (! refitPending_) {
+          refitPending_ = true;
+
+          QTimer::singleShot(0, this, SLOT(refitSlot()));
+        }
+      }
+
+      updateGeometry();
     }
   }
+
+  return QWidget::eventFilter(obj, e);
 }
 
 int
@@ -2040,7 +1804,7 @@ updateRubberBand()
       int hs = CQTileAreaConstants::highlight_size;
 
       if      (highlight_.ind >= 0) {
-        const PlacementArea &area = placementAreas_[uint(highlight_.ind)];
+        const PlacementArea &area = placementAreas()[uint(highlight_.ind)];
 
         if      (highlight_.side == LEFT_SIDE)
           rect = QRect(area.x1() - hs/2, area.y1(), hs/2, area.y2() - area.y1());
@@ -2072,9 +1836,10 @@ updateRubberBand()
       pid = highlight_.ind;
 
     if (pid >= 0) {
-      PlacementArea &placementArea = placementAreas_[uint(pid)];
+      PlacementArea &placementArea = placementAreas()[uint(pid)];
 
-      rect = placementArea.rect().adjusted(tl.x(), tl.y(), tl.x(), tl.y());
+      rect = QRect(placementArea.x, placementArea.y, placementArea.width, placementArea.height).
+               adjusted(tl.x(), tl.y(), tl.x(), tl.y());
 
       rubberBand_->setGeometry(rect);
 
@@ -2095,160 +1860,86 @@ hideRubberBand()
   rubberBand_->hide();
 }
 
-void
+// start drag of splitter (all splitters on same row/column edge). Allowed range and
+// pushed splitters are precomputed by layout so moves need no size queries
+bool
 CQTileArea::
-moveHSplitter(int row, int ind, int dy)
+beginSplitterDrag(Qt::Orientation orient, int pos)
 {
-  HSplitter &splitter = hsplitters_[row][uint(ind)];
-
-  // limit dy
-  for (AreaSet::iterator pt = splitter.tareas.begin(); pt != splitter.tareas.end(); ++pt) {
-    int pid = *pt;
-
-    PlacementArea &placementArea = placementAreas_[uint(pid)];
-
-    auto *area = getAreaForId(placementArea.areaId);
-
-    int min_size = (area ? area->minimumSizeHint().height() : CQTileAreaConstants::min_size);
-
-    if (dy < 0 && placementArea.height + dy <= min_size)
-      dy = min_size - placementArea.height;
-  }
-
-  for (AreaSet::iterator pb = splitter.bareas.begin(); pb != splitter.bareas.end(); ++pb) {
-    int pid = *pb;
-
-    PlacementArea &placementArea = placementAreas_[uint(pid)];
-
-    auto *area = getAreaForId(placementArea.areaId);
-
-    int min_size = (area ? area->minimumSizeHint().height() : CQTileAreaConstants::min_size);
-
-    if (dy > 0 && placementArea.height - dy <= min_size)
-      dy = placementArea.height - min_size;
-  }
-
-  // apply dy to placement areas
-  for (AreaSet::iterator pt = splitter.tareas.begin(); pt != splitter.tareas.end(); ++pt) {
-    int pid = *pt;
-
-    PlacementArea &placementArea = placementAreas_[uint(pid)];
-
-    placementArea.height += dy;
-
-    updatePlacementGeometry(placementArea);
-  }
-
-  for (AreaSet::iterator pb = splitter.bareas.begin(); pb != splitter.bareas.end(); ++pb) {
-    int pid = *pb;
-
-    PlacementArea &placementArea = placementAreas_[uint(pid)];
-
-    placementArea.y      += dy;
-    placementArea.height -= dy;
-
-    updatePlacementGeometry(placementArea);
-  }
+  if (orient == Qt::Horizontal)
+    return layout_.beginHSplitterDrag(pos);
+  else
+    return layout_.beginVSplitterDrag(pos);
 }
 
+// move dragged splitter to mouse offset from drag start
 void
 CQTileArea::
-moveVSplitter(int col, int ind, int dx)
+dragSplitter(int d)
 {
-  // move current vertical splitter by mouse delta
-  VSplitter &splitter = vsplitters_[col][uint(ind)];
-
-  // limit dx
-  for (AreaSet::iterator pl = splitter.lareas.begin(); pl != splitter.lareas.end(); ++pl) {
-    int pid = *pl;
-
-    PlacementArea &placementArea = placementAreas_[uint(pid)];
-
-    auto *area = getAreaForId(placementArea.areaId);
-
-    int min_size = (area ? area->minimumSizeHint().width() : CQTileAreaConstants::min_size);
-
-    if (dx < 0 && placementArea.width + dx <= min_size)
-      dx = min_size - placementArea.width;
-  }
-
-  for (AreaSet::iterator pr = splitter.rareas.begin(); pr != splitter.rareas.end(); ++pr) {
-    int pid = *pr;
-
-    PlacementArea &placementArea = placementAreas_[uint(pid)];
+  layout_.dragSplitter(d, changedAreas_);
 
-    auto *area = getAreaForId(placementArea.areaId);
-
-    int min_size = (area ? area->minimumSizeHint().width() : CQTileAreaConstants::min_size);
-
-    if (dx > 0 && placementArea.width - dx <= min_size)
-      dx = placementArea.width - min_size;
-  }
-
-  // apply dx to placement areas
-  for (AreaSet::iterator pl = splitter.lareas.begin(); pl != splitter.lareas.end(); ++pl) {
-    int pid = *pl;
-
-    PlacementArea &placementArea = placementAreas_[uint(pid)];
-
-    placementArea.width += dx;
+  updatePlacementGeometries(changedAreas_);
+}
 
-    updatePlacementGeometry(placementArea);
-  }
+// end splitter drag
+void
+CQTileArea::
+endSplitterDrag()
+{
+  layout_.endSplitterDrag();
+}
 
-  for (AreaSet::iterator pr = splitter.rareas.begin(); pr != splitter.rareas.end(); ++pr) {
-    int pid = *pr;
+// end drag (and undo step) of painted splitter. Pressed splitter may already be
+// reset if splitters were updated during the drag
+void
+CQTileArea::
+endSplitterMouseDrag()
+{
+  if (! splitterMouse_.dragging)
+    return;
 
-    PlacementArea &placementArea = placementAreas_[uint(pid)];
+  splitterMouse_.pressed  = -1;
+  splitterMouse_.dragging = false;
 
-    placementArea.x     += dx;
-    placementArea.width -= dx;
+  endSplitterDrag();
 
-    updatePlacementGeometry(placementArea);
-  }
+  endUndoStep();
 }
 
-// get horizontal splitter at position
+// get horizontal splitter at position (splitters at point from splitter index)
 CQTileArea::SplitterInd
 CQTileArea::
 getHSplitterAtPos(const QPoint &pos) const
 {
-  for (RowHSplitterArray::const_iterator p = hsplitters_.begin(); p != hsplitters_.end(); ++p) {
-    const HSplitterArray &splitters = (*p).second;
+  std::vector<int> inds;
 
-    uint ns = uint(splitters.size());
+  splitterIndex_.findOverlapping(CTileRectIndex::Rect(pos.x(), pos.y(), 1, 1), inds);
 
-    for (uint i = 0; i < ns; ++i) {
-      const HSplitter &splitter = splitters[i];
+  for (int i : inds) {
+    const SplitterRect &splitterRect = splitterRects_[uint(i)];
 
-      auto *splitterWidget = getSplitterWidget(splitter.splitterId);
-
-      if (splitterWidget->rect().contains(pos))
-        return SplitterInd((*p).first, i);
-    }
+    if (splitterRect.orient == Qt::Horizontal)
+      return SplitterInd(splitterRect.pos, splitterRect.ind);
   }
 
   return SplitterInd(-1, -1);
 }
 
-// get vertical splitter at position
+// get vertical splitter at position (splitters at point from splitter index)
 CQTileArea::SplitterInd
 CQTileArea::
 getVSplitterAtPos(const QPoint &pos) const
 {
-  for (ColVSplitterArray::const_iterator p = vsplitters_.begin(); p != vsplitters_.end(); ++p) {
-    const VSplitterArray &splitters = (*p).second;
-
-    uint ns = uint(splitters.size());
+  std::vector<int> inds;
 
-    for (uint i = 0; i < ns; ++i) {
-      const VSplitter &splitter = splitters[i];
+  splitterIndex_.findOverlapping(CTileRectIndex::Rect(pos.x(), pos.y(), 1, 1), inds);
 
-      auto *splitterWidget = getSplitterWidget(splitter.splitterId);
+  for (int i : inds) {
+    const SplitterRect &splitterRect = splitterRects_[uint(i)];
 
-      if (splitterWidget->rect().contains(pos))
-        return SplitterInd((*p).first, i);
-    }
+    if (splitterRect.orient == Qt::Vertical)
+      return SplitterInd(splitterRect.pos, splitterRect.ind);
   }
 
   return SplitterInd(-1, -1);
@@ -2272,88 +1963,55 @@ setHighlight(const QPoint &pos)
 
   //-------
 
-  // check inside each placement area
+  // position relative to area
+  int px = pos.x() - tl.x();
+  int py = pos.y() - tl.y();
+
+  // find nearest placement area side or center (squared distances).
+  // Distance to side or center of an area is never less than the distance to its
+  // rectangle so, once the areas under the point give a nearest distance, only areas
+  // in the square of that radius around the point need to be checked
   int  minD    = INT_MAX;
   int  minI    = -1     ;
   Side minSide = LEFT_SIDE;
 
-  uint np = uint(placementAreas_.size());
+  int np = int(placementAreas().size());
 
-  for (uint i = 0; i < np; ++i) {
-    const PlacementArea &placementArea = placementAreas_[i];
-
-    // determine nearest side or center depending on distance to edges or rectangle center
-    int dx1 = abs(tl.x() + placementArea.x1() - pos.x());
-    int dy1 = abs(tl.y() + placementArea.y1() - pos.y());
-    int dx2 = abs(tl.x() + placementArea.x2() - pos.x());
-    int dy2 = abs(tl.y() + placementArea.y2() - pos.y());
-
-    int  d;
-    Side side = NO_SIDE;
-
-    // to left of area
-    if      (pos.x() < tl.x() + placementArea.x1()) {
-      if      (pos.y() < tl.y() + placementArea.y1()) {
-        d    = int(std::sqrt(double(dx1*dx1 + dy1*dy1)));
-        side = (dx1 < dy1 ? LEFT_SIDE : TOP_SIDE);
-      }
-      else if (pos.y() > tl.y() + placementArea.y2()) {
-        d    = int(std::sqrt(double(dx1*dx1 + dy2*dy2)));
-        side = (dx1 < dy1 ? LEFT_SIDE : BOTTOM_SIDE);
-      }
-      else {
-        d    = dx1;
-        side = LEFT_SIDE;
-      }
-    }
-    // to right of area
-    else if (pos.x() > tl.x() + placementArea.x2()) {
-      if      (pos.y() < tl.y() + placementArea.y1()) {
-        d    = int(std::sqrt(double(dx2*dx2 + dy1*dy1)));
-        side = (dx1 < dy1 ? RIGHT_SIDE : TOP_SIDE);
-      }
-      else if (pos.y() > tl.y() + placementArea.y2()) {
-        d    = int(std::sqrt(double(dx2*dx2 + dy2*dy2)));
-        side = (dx1 < dy1 ? RIGHT_SIDE : BOTTOM_SIDE);
-      }
-      else {
-        d    = dx2;
-        side = RIGHT_SIDE;
-      }
-    }
-    // inside (x) of area
-    else {
-      if      (pos.y() < tl.y() + placementArea.y1()) {
-        d    = dy1;
-        side = TOP_SIDE;
-      }
-      else if (pos.y() > tl.y() + placementArea.y2()) {
-        d    = dy2;
-        side = BOTTOM_SIDE;
-      }
-      else {
-        d = std::min(dx1, std::min(dx2, std::min(dy1, dy2)));
+  auto checkArea = [&](int i) {
+    int  d, dm;
+    Side side;
 
-        if      (dx1 == d) side = LEFT_SIDE;
-        else if (dx2 == d) side = RIGHT_SIDE;
-        else if (dy1 == d) side = TOP_SIDE;
-        else if (dy2 == d) side = BOTTOM_SIDE;
-        else assert(false);
-      }
-    }
+    highlightDist(placementAreas()[uint(i)], px, py, d, side, dm);
+
+    // update nearest side then check center distance
+    if (d  < minD) { minD = d ; minI = i; minSide = side       ; }
+    if (dm < minD) { minD = dm; minI = i; minSide = MIDDLE_SIDE; }
+  };
+
+  std::vector<int> inds;
+
+  if (placementIndex_.size() == np)
+    placementIndex_.findOverlapping(CTileRectIndex::Rect(px, py, 1, 1), inds);
 
-    // update nearest side
-    if (d < minD) { minD = d; minI = int(i); minSide = side; }
+  for (int i : inds)
+    checkArea(i);
 
-    int dxm = abs(tl.x() + placementArea.xm() - pos.x());
-    int dym = abs(tl.y() + placementArea.ym() - pos.y());
+  if (minI >= 0) {
+    int r = int(std::ceil(std::sqrt(double(minD))));
 
-    //----
+    placementIndex_.findOverlapping(CTileRectIndex::Rect(px - r, py - r, 2*r + 1, 2*r + 1), inds);
 
-    // check center distance
-    d = int(std::sqrt(double(dxm*dxm + dym*dym)));
+    // recheck in index order so ties pick same area as full scan
+    minD = INT_MAX;
+    minI = -1;
 
-    if (d < minD) { minD = d; minI = int(i); minSide = MIDDLE_SIDE; }
+    for (int i : inds)
+      checkArea(i);
+  }
+  // not over an area (border or splitter gap) so check all areas
+  else {
+    for (int i = 0; i < np; ++i)
+      checkArea(i);
   }
 
   //------
@@ -2365,6 +2023,76 @@ setHighlight(const QPoint &pos)
     (void) updateRubberBand();
 }
 
+// get squared distance of point (relative to area) to nearest side and to center of
+// placement area
+void
+CQTileArea::
+highlightDist(const PlacementArea &placementArea, int px, int py,
+              int &d, Side &side, int &dm) const
+{
+  int dx1 = abs(placementArea.x1() - px);
+  int dy1 = abs(placementArea.y1() - py);
+  int dx2 = abs(placementArea.x2() - px);
+  int dy2 = abs(placementArea.y2() - py);
+
+  // to left of area
+  if      (px < placementArea.x1()) {
+    if      (py < placementArea.y1()) {
+      d    = dx1*dx1 + dy1*dy1;
+      side = (dx1 < dy1 ? LEFT_SIDE : TOP_SIDE);
+    }
+    else if (py > placementArea.y2()) {
+      d    = dx1*dx1 + dy2*dy2;
+      side = (dx1 < dy1 ? LEFT_SIDE : BOTTOM_SIDE);
+    }
+    else {
+      d    = dx1*dx1;
+      side = LEFT_SIDE;
+    }
+  }
+  // to right of area
+  else if (px > placementArea.x2()) {
+    if      (py < placementArea.y1()) {
+      d    = dx2*dx2 + dy1*dy1;
+      side = (dx1 < dy1 ? RIGHT_SIDE : TOP_SIDE);
+    }
+    else if (py > placementArea.y2()) {
+      d    = dx2*dx2 + dy2*dy2;
+      side = (dx1 < dy1 ? RIGHT_SIDE : BOTTOM_SIDE);
+    }
+    else {
+      d    = dx2*dx2;
+      side = RIGHT_SIDE;
+    }
+  }
+  // inside (x) of area
+  else {
+    if      (py < placementArea.y1()) {
+      d    = dy1*dy1;
+      side = TOP_SIDE;
+    }
+    else if (py > placementArea.y2()) {
+      d    = dy2*dy2;
+      side = BOTTOM_SIDE;
+    }
+    else {
+      int d1 = std::min(dx1, std::min(dx2, std::min(dy1, dy2)));
+
+      if      (dx1 == d1) side = LEFT_SIDE;
+      else if (dx2 == d1) side = RIGHT_SIDE;
+      else if (dy1 == d1) side = TOP_SIDE;
+      else                side = BOTTOM_SIDE;
+
+      d = d1*d1;
+    }
+  }
+
+  int dxm = abs(placementArea.xm() - px);
+  int dym = abs(placementArea.ym() - py);
+
+  dm = dxm*dxm + dym*dym;
+}
+
 // clear highlight
 void
 CQTileArea::
@@ -2387,7 +2115,7 @@ getHighlightPos(Side &side, int &row1, int &col1, int &row2, int &col2)
   if (highlight_.ind >= 0) {
     side = highlight_.side;
 
-    const PlacementArea &area = placementAreas_[uint(highlight_.ind)];
+    const PlacementArea &area = placementAreas()[uint(highlight_.ind)];
 
     if      (highlight_.side == LEFT_SIDE) {
       row1 = area.row1(); row2 = area.row2();
@@ -2430,21 +2158,25 @@ saveState(PlacementState &state, bool transient)
   // save grid, placement and splitters
   state.valid_          = true;
   state.transient_      = transient;
-  state.grid_           = grid_;
-  state.placementAreas_ = placementAreas_;
-  state.hsplitters_     = hsplitters_;
-  state.vsplitters_     = vsplitters_;
+  state.grid_           = grid();
+  state.placementAreas_ = placementAreas();
+  state.hsplitters_     = hsplitters();
+  state.vsplitters_     = vsplitters();
 
   // for transient we know we are not modifying the data so we don't
   // need to save the windows for each area
+  state.areaWindows_.clear();
+
   if (! transient) {
-    for (uint i = 0; i < placementAreas_.size(); ++i) {
-      auto *area = getAreaForId(placementAreas_[i].areaId);
+    state.areaWindows_.resize(placementAreas().size());
+
+    for (uint i = 0; i < placementAreas().size(); ++i) {
+      auto *area = getAreaForId(placementAreas()[i].areaId);
       assert(area);
 
       const auto &areaWindows = area->getWindows();
 
-      state.placementAreas_[i].windows = areaWindows;
+      state.areaWindows_[i] = areaWindows;
     }
   }
 }
@@ -2454,23 +2186,22 @@ void
 CQTileArea::
 restoreState(const PlacementState &state)
 {
-  assert(state.valid_);
-
   // restore grid, placement areas and splitters
-  grid_           = state.grid_;
-  placementAreas_ = state.placementAreas_;
-  hsplitters_     = state.hsplitters_;
-  vsplitters_     = state.vsplitters_;
+  setLayoutState(state);
+
+  updateSplitterWidgets();
 
   // if not transient then rebuild all the areas from the saved area windows
   if (! state.transient_) {
     int currentAreaInd = -1;
 
-    for (uint i = 0; i < placementAreas_.size(); ++i) {
-      PlacementArea &area = placementAreas_[i];
+    for (uint i = 0; i < placementAreas().size(); ++i) {
+      PlacementArea &area = placementAreas()[i];
+
+      const Windows &windows = state.areaWindows_[i];
 
       // reparent windows so not deleted
-      for (Windows::iterator p = area.windows.begin(); p != area.windows.end(); ++p)
+      for (Windows::const_iterator p = windows.begin(); p != windows.end(); ++p)
         (*p)->setParent(this);
 
       if (area.areaId == currentArea_->id())
@@ -2482,23 +2213,25 @@ restoreState(const PlacementState &state)
 
     areas_.clear();
 
+    areaSizeHints_.clear();
+
     currentArea_ = nullptr;
 
     // create new areas for placement areas
-    for (uint i = 0; i < placementAreas_.size(); ++i) {
-      PlacementArea &area = placementAreas_[i];
+    for (uint i = 0; i < placementAreas().size(); ++i) {
+      const Windows &windows = state.areaWindows_[i];
 
       auto *newArea = addArea();
 
       // add windows to area
-      for (Windows::iterator p = area.windows.begin(); p != area.windows.end(); ++p)
+      for (Windows::const_iterator p = windows.begin(); p != windows.end(); ++p)
         newArea->addWindow(*p);
 
       // replace old id in grid with new id
-      grid_.replace(placementAreas_[i].areaId, newArea->id());
+      grid().replace(placementAreas()[i].areaId, newArea->id());
 
       // update placement area id
-      placementAreas_[i].areaId = newArea->id();
+      layout_.setPlacementAreaId(int(i), newArea->id());
 
       // update current area
       if (int(i) == currentAreaInd)
@@ -2513,15 +2246,344 @@ restoreState(const PlacementState &state)
     }
 
     if (CQTileAreaConstants::debug_grid)
-      grid_.print(std::cerr);
+      grid().print(std::cerr);
 
     emitCurrentWindowChanged();
+
+    // areas are recreated (with new ids) so layout history can not be applied
+    clearUndo();
+  }
+
+  // update widgets to new sizes
+  adjustToFit();
+
+  updatePlacementGeometries();
+}
+
+// set grid, placement areas and splitters from state (widgets are not updated but
+// placement index is so highlight can be found for state)
+void
+CQTileArea::
+setLayoutState(const PlacementState &state)
+{
+  assert(state.valid_);
+
+  grid()           = state.grid_;
+  placementAreas() = state.placementAreas_;
+  hsplitters()     = state.hsplitters_;
+  vsplitters()     = state.vsplitters_;
+
+  layout_.updatePlacementAreaIndices();
+
+  layout_.invalidate();
+
+  int np = int(placementAreas().size());
+
+  placementIndex_.reset(np);
+
+  for (int i = 0; i < np; ++i)
+    updatePlacementIndex(i);
+}
+
+// apply saved state to widgets. State placement is already fitted to the area size so
+// only changed geometries are set (sizes are resolved on next fit)
+void
+CQTileArea::
+applyLayoutState(const PlacementState &state)
+{
+  setLayoutState(state);
+
+  updateSplitterWidgets();
+
+  updatePlacementGeometries();
+
+  updateTitles();
+}
+
+// undo last layout change
+void
+CQTileArea::
+undoSlot()
+{
+  (void) undo();
+}
+
+// redo last undone layout change
+void
+CQTileArea::
+redoSlot()
+{
+  (void) redo();
+}
+
+// undo last layout change
+bool
+CQTileArea::
+undo()
+{
+  if (undoDeltas_.empty())
+    return false;
+
+  // history is no longer usable if layout was changed outside of it
+  if (! applyLayoutDelta(undoDeltas_.back(), true)) {
+    clearUndo();
+    return false;
+  }
+
+  redoDeltas_.push_back(std::move(undoDeltas_.back()));
+
+  undoDeltas_.pop_back();
+
+  return true;
+}
+
+// redo last undone layout change
+bool
+CQTileArea::
+redo()
+{
+  if (redoDeltas_.empty())
+    return false;
+
+  if (! applyLayoutDelta(redoDeltas_.back(), false)) {
+    clearUndo();
+    return false;
+  }
+
+  undoDeltas_.push_back(std::move(redoDeltas_.back()));
+
+  redoDeltas_.pop_back();
+
+  return true;
+}
+
+// clear undo/redo history
+void
+CQTileArea::
+clearUndo()
+{
+  undoDeltas_.clear();
+  redoDeltas_.clear();
+}
+
+// start recording layout change (grid changes are recorded until outermost step ends)
+void
+CQTileArea::
+beginUndoStep()
+{
+  if (undoDepth_++ > 0)
+    return;
+
+  undoDelta_ = LayoutDelta();
+
+  undoDelta_.stamp1    = grid().stamp();
+  undoDelta_.rowEdges1 = grid().rowEdges();
+  undoDelta_.colEdges1 = grid().colEdges();
+
+  grid().setChanges(&undoDelta_.changes);
+}
+
+// end recording layout change and add changes to undo history
+void
+CQTileArea::
+endUndoStep()
+{
+  assert(undoDepth_ > 0);
+
+  if (--undoDepth_ > 0)
+    return;
+
+  grid().setChanges(nullptr);
+
+  LayoutDelta delta = std::move(undoDelta_);
+
+  undoDelta_ = LayoutDelta();
+
+  delta.stamp2 = grid().stamp();
+
+  // grid replaced (not changed) during step so changes don't lead to current grid
+  uint64_t stamp = (delta.changes.empty() ? delta.stamp1 : delta.changes.stamp);
+
+  if (delta.stamp2 != stamp) {
+    clearUndo();
+    return;
+  }
+
+  // only keep edges if changed
+  delta.edgesChanged = (delta.rowEdges1 != grid().rowEdges() ||
+                        delta.colEdges1 != grid().colEdges());
+
+  if (delta.edgesChanged) {
+    delta.rowEdges2 = grid().rowEdges();
+    delta.colEdges2 = grid().colEdges();
+  }
+  else {
+    delta.rowEdges1 = CTileGridEdges();
+    delta.colEdges1 = CTileGridEdges();
+  }
+
+  if (delta.isEmpty())
+    return;
+
+  undoDeltas_.push_back(std::move(delta));
+
+  if (int(undoDeltas_.size()) > CQTileAreaConstants::max_undo)
+    undoDeltas_.pop_front();
+
+  redoDeltas_.clear();
+}
+
+// apply old (undo) or new (redo) side of layout change and rebuild placement from grid
+bool
+CQTileArea::
+applyLayoutDelta(const LayoutDelta &delta, bool undo)
+{
+  // check grid matches other side of change and all areas set by it still exist
+  if (grid().stamp() != (undo ? delta.stamp2 : delta.stamp1))
+    return false;
+
+  std::vector<int> ids;
+
+  delta.changes.getIds(undo, ids);
+
+  for (int id : ids)
+    if (id > 0 && ! getAreaForId(id))
+      return false;
+
+  //---
+
+  // replay grid changes on copy of grid so a failed replay leaves layout unchanged
+  // (edges are changed by inserted and removed rows/columns so are restored after)
+  Grid grid1 = grid();
+
+  if (! CTileGridTypes::applyChanges(grid1, delta.changes, undo))
+    return false;
+
+  grid1.setStamp(undo ? delta.stamp1 : delta.stamp2);
+
+  if (delta.edgesChanged) {
+    grid1.rowEdges() = (undo ? delta.rowEdges1 : delta.rowEdges2);
+    grid1.colEdges() = (undo ? delta.colEdges1 : delta.colEdges2);
+  }
+  else {
+    grid1.rowEdges() = grid().rowEdges();
+    grid1.colEdges() = grid().colEdges();
+  }
+
+  grid() = std::move(grid1);
+
+  //---
+
+  // rebuild placement areas and splitters from grid (keeping edges)
+  gridToPlacement(true);
+
+  // dock areas added back to grid and float areas removed from grid
+  for (auto pa : areas_) {
+    auto *area = pa.second;
+
+    bool placed = (getPlacementAreaIndex(area->id()) >= 0);
+
+    if      (placed && ! area->isDocked()) {
+      area->setDetached(false);
+      area->setFloating(false);
+    }
+    else if (! placed && area->isDocked()) {
+      int detachPos = area->getDetachPos(area->width(), area->height());
+
+      area->setFloated();
+
+      area->move(detachPos, detachPos);
+    }
   }
 
+  //---
+
   // update widgets to new sizes
   adjustToFit();
 
   updatePlacementGeometries();
+
+  updateTitles();
+
+  update();
+
+  return true;
+}
+
+// update splitter widgets (used state and key) from splitters
+void
+CQTileArea::
+updateSplitterWidgets()
+{
+  for (auto ps : splitterWidgets_) {
+    auto *splitter = ps.second;
+
+    splitter->setUsed(false);
+  }
+
+  // painted splitters have no widget
+  if (paintSplitters_) {
+    for (auto &ps : hsplitters()) {
+      for (auto &splitter : ps.second)
+        splitter.splitterId = -1;
+    }
+
+    for (auto &ps : vsplitters()) {
+      for (auto &splitter : ps.second)
+        splitter.splitterId = -1;
+    }
+
+    updateAreaSplitters();
+
+    return;
+  }
+
+  for (const auto &ps : hsplitters()) {
+    const HSplitterArray &splitters = ps.second;
+
+    for (uint i = 0; i < splitters.size(); ++i) {
+      auto *splitter = getSplitterWidget(splitters[i].splitterId);
+      if (! splitter) continue;
+
+      splitter->init(Qt::Horizontal, ps.first, int(i));
+
+      splitter->setUsed(true);
+    }
+  }
+
+  for (const auto &ps : vsplitters()) {
+    const VSplitterArray &splitters = ps.second;
+
+    for (uint i = 0; i < splitters.size(); ++i) {
+      auto *splitter = getSplitterWidget(splitters[i].splitterId);
+      if (! splitter) continue;
+
+      splitter->init(Qt::Vertical, ps.first, int(i));
+
+      splitter->setUsed(true);
+    }
+  }
+
+  // add widgets for splitters without one (previously painted)
+  for (auto &ps : hsplitters()) {
+    HSplitterArray &splitters = ps.second;
+
+    for (uint i = 0; i < splitters.size(); ++i) {
+      if (! getSplitterWidget(splitters[i].splitterId))
+        splitters[i].splitterId = createSplitterWidget(Qt::Horizontal, ps.first, int(i));
+    }
+  }
+
+  for (auto &ps : vsplitters()) {
+    VSplitterArray &splitters = ps.second;
+
+    for (uint i = 0; i < splitters.size(); ++i) {
+      if (! getSplitterWidget(splitters[i].splitterId))
+        splitters[i].splitterId = createSplitterWidget(Qt::Vertical, ps.first, int(i));
+    }
+  }
+
+  updateAreaSplitters();
 }
 
 // get area for id
@@ -2537,21 +2599,12 @@ getAreaForId(int areaId) const
     return nullptr;
 }
 
-// set default placement size
-void
-CQTileArea::
-setDefPlacementSize(int w, int h)
-{
-  defWidth_  = w;
-  defHeight_ = h;
-}
-
 // print grid (debug)
 void
 CQTileArea::
 printSlot()
 {
-  grid_.print(std::cerr);
+  grid().print(std::cerr);
 }
 
 // fill empty areas (debug)
@@ -2587,11 +2640,55 @@ void
 CQTileArea::
 adjustSlot()
 {
+  layout_.invalidate();
+
   adjustToFit();
 
   updatePlacementGeometries();
 }
 
+// refit layout for changed area size hints. Only the changed areas are requeried and
+// only the axes where their placement areas no longer fit are solved again
+void
+CQTileArea::
+refitSlot()
+{
+  std::vector<int> areaIds;
+
+  areaIds.swap(refitAreas_);
+
+  refitPending_ = false;
+
+  // layout change started since request so refit at its end
+  if (layoutDepth_ > 0) {
+    placementPending_ = true;
+    return;
+  }
+
+  // hidden area gets full update when shown
+  if (! isVisible())
+    return;
+
+  std::sort(areaIds.begin(), areaIds.end());
+
+  areaIds.erase(std::unique(areaIds.begin(), areaIds.end()), areaIds.end());
+
+  // update size constraints of changed areas (marks axes they do not fit as dirty)
+  for (int id : areaIds) {
+    auto *area = getAreaForId(id);
+
+    if (area)
+      layout_.setAreaSize(id, getLayoutAreaSize(area));
+  }
+
+  if (! layout_.isDirty())
+    return;
+
+  layout_.adjustToFit();
+
+  updatePlacementGeometries();
+}
+
 // return size hint
 QSize
 CQTileArea::
@@ -2600,25 +2697,25 @@ sizeHint() const
   std::map<int, int> widths;
   std::map<int, int> heights;
 
-  int ncells = grid_.nrows()*grid_.ncols();
+  int ncells = grid().nrows()*grid().ncols();
 
   for (int ci = 0; ci < ncells; ++ci) {
-    int cell = grid_.cell(ci);
+    int cell = grid().cell(ci);
     if (cell < 0) continue;
 
     int pid = getPlacementAreaIndex(cell);
     if (pid < 0) continue;
 
-    const PlacementArea &placementArea = placementAreas_[uint(pid)];
+    const PlacementArea &placementArea = placementAreas()[uint(pid)];
     if (! placementArea.areaId) continue;
 
     auto *area = getAreaForId(placementArea.areaId);
     if (! area) continue;
 
-    int r = ci / grid_.ncols();
-    int c = ci % grid_.ncols();
+    int r = ci / grid().ncols();
+    int c = ci % grid().ncols();
 
-    auto s = area->sizeHint();
+    const QSize &s = getAreaSizeHints(area).prefSize;
 
     widths [c] = std::max(widths [c], s.width ()/placementArea.ncols);
     heights[r] = std::max(heights[r], s.height()/placementArea.nrows);
@@ -2626,10 +2723,10 @@ sizeHint() const
 
   int w = 0, h = 0;
 
-  for (int c = 0; c > grid_.ncols(); ++c)
+  for (int c = 0; c > grid().ncols(); ++c)
     w += widths[c];
 
-  for (int r = 0; r > grid_.nrows(); ++r)
+  for (int r = 0; r > grid().nrows(); ++r)
     h += heights[r];
 
   return QSize(w, h);
@@ -2644,8 +2741,8 @@ minimumSizeHint() const
 
   int fh = fm.height() + 4;
 
-  int w = grid_.ncols()*4;
-  int h = grid_.nrows()*(fh + 4);
+  int w = grid().ncols()*4;
+  int h = grid().nrows()*(fh + 4);
 
   return QSize(w, h);
 }
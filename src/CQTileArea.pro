@@ -24,7 +24,13 @@ HEADERS += \
 ../include/CQTileWindowTabBar.h \
 ../include/CQTileWindowTitle.h \
 ../include/CQWidgetResizer.h \
+../include/CTileConstraintSolver.h \
 ../include/CTileGrid.h \
+../include/CTileGridEdges.h \
+../include/CTileGridTypes.h \
+../include/CTileLayout.h \
+../include/CTileSmallVector.h \
+../include/CTileRectIndex.h \
 
 SOURCES += \
 CQRubberBand.cpp \
@@ -38,7 +44,6 @@ CQTileWindow.cpp \
 CQTileWindowTabBar.cpp \
 CQTileWindowTitle.cpp \
 CQWidgetResizer.cpp \
-CTileGrid.cpp \
 
 OBJECTS_DIR = ../obj
 
@@ -29,12 +29,16 @@ init(Qt::Orientation orient, int pos, int ind)
     setCursor(Qt::SplitVCursor);
 }
 
+// set used (unused splitter is hidden and ends its drag as it gets no mouse release)
 void
 CQTileAreaSplitter::
 setUsed(bool used)
 {
   used_ = used;
 
+  if (! used_)
+    endDrag();
+
   setVisible(used_);
 }
 
@@ -68,6 +72,12 @@ mousePressEvent(QMouseEvent *e)
   mouseState_.pressed  = true;
   mouseState_.pressPos = e->globalPos();
 
+  // record splitter move as single undo step
+  area_->beginUndoStep();
+
+  // plan drag (allowed range and pushed splitters)
+  area_->beginSplitterDrag(orient_, pos_);
+
   update();
 }
 
@@ -78,18 +88,11 @@ mouseMoveEvent(QMouseEvent *e)
 {
   if (! mouseState_.pressed) return;
 
-  if (orient_ == Qt::Horizontal) {
-    int dy = e->globalPos().y() - mouseState_.pressPos.y();
-
-    area_->moveHSplitter(pos_, ind_, dy);
-  }
-  else {
-    int dx = e->globalPos().x() - mouseState_.pressPos.x();
-
-    area_->moveVSplitter(pos_, ind_, dx);
-  }
-
-  mouseState_.pressPos = e->globalPos();
+  // move by offset from press position (moving back restores pushed splitters)
+  if (orient_ == Qt::Horizontal)
+    area_->dragSplitter(e->globalPos().y() - mouseState_.pressPos.y());
+  else
+    area_->dragSplitter(e->globalPos().x() - mouseState_.pressPos.x());
 
   update();
 }
@@ -99,11 +102,34 @@ void
 CQTileAreaSplitter::
 mouseReleaseEvent(QMouseEvent *)
 {
-  mouseState_.pressed = false;
+  endDrag();
 
   update();
 }
 
+// handle hide (hidden splitter gets no mouse release so end drag now)
+void
+CQTileAreaSplitter::
+hideEvent(QHideEvent *)
+{
+  endDrag();
+}
+
+// end drag (and its undo step) if in progress
+void
+CQTileAreaSplitter::
+endDrag()
+{
+  if (! mouseState_.pressed)
+    return;
+
+  mouseState_.pressed = false;
+
+  area_->endSplitterDrag();
+
+  area_->endUndoStep();
+}
+
 void
 CQTileAreaSplitter::
 enterEvent(QEvent *)
@@ -105,6 +105,9 @@ addWindow(CQTileWindow *window)
 
   // show tabbar if more than one window
   tabBar_->setVisible(tabBar_->count() > 1);
+
+  // new tab changes size hints
+  area_->invalidateAreaSizeHints(this);
 }
 
 // remove window from area
@@ -137,6 +140,9 @@ removeWindow(CQTileWindow *window)
     }
   }
 
+  // removed tab changes size hints
+  area_->invalidateAreaSizeHints(this);
+
   return windows_.empty();
 }
 
@@ -348,6 +354,11 @@ startAttachPreview()
 
   attachData_.state.valid_ = false;
 
+  // no cached preview states
+  attachData_.previews.clear();
+
+  attachData_.areaSize = area()->size();
+
   // no drop point set
   attachData_.rect = QRect();
   attachData_.side = CQTileArea::NO_SIDE;
@@ -369,6 +380,8 @@ stopAttachPreview()
     attachData_.state.valid_ = false;
   }
 
+  attachData_.previews.clear();
+
   // hide rubber band and stop timer
   area()->hideRubberBand();
 
@@ -394,10 +407,21 @@ attachPreviewSlot()
   if (! attachData_.rect.isNull() && attachData_.rect.contains(pos))
     return;
 
-  // restore placement
+  // detached state is restored on stop
   attachData_.state.valid_ = true;
 
-  area()->restoreState(attachData_.state);
+  // cached preview states are only valid for area size (refit detached state)
+  if (area()->size() != attachData_.areaSize) {
+    attachData_.previews.clear();
+
+    attachData_.areaSize = area()->size();
+
+    area()->restoreState(attachData_.state);
+    area()->saveState   (attachData_.state);
+  }
+
+  // set detached layout (widgets are updated when preview is applied)
+  area()->setLayoutState(attachData_.state);
 
   // set highlight to current mouse position
   area()->setHighlight(pos);
@@ -407,8 +431,24 @@ attachPreviewSlot()
   int              row1, col1, row2, col2;
 
   if (area()->getHighlightPos(side, row1, col1, row2, col2)) {
-    // preview attached
-    attach(side, row1, col1, row2, col2, true);
+    // preview onto existing area is detached layout
+    if (side == CQTileArea::MIDDLE_SIDE)
+      area()->applyLayoutState(attachData_.state);
+    else {
+      PreviewKey key(int(side), row1, col1, row2, col2);
+
+      auto p = attachData_.previews.find(key);
+
+      // apply preview state of previously visited drop target
+      if (p != attachData_.previews.end())
+        area()->applyLayoutState((*p).second);
+      // preview attached and cache resulting state
+      else {
+        attach(side, row1, col1, row2, col2, true);
+
+        area()->saveState(attachData_.previews[key]);
+      }
+    }
 
     auto rect = area()->updateRubberBand();
 
@@ -422,6 +462,8 @@ attachPreviewSlot()
   }
   else {
     // keep detached
+    area()->applyLayoutState(attachData_.state);
+
     auto rect = area()->updateRubberBand();
 
     // update state
@@ -467,6 +509,10 @@ attach(CQTileArea::Side side, int row1, int col1, int row2, int col2, bool previ
 
   //---
 
+  // record attach as single undo step (preview is not recorded)
+  if (! preview)
+    area_->beginUndoStep();
+
   auto *attachArea = (! preview ? this : nullptr);
 
   // add rows for top/bottom and add at specified row and column range
@@ -489,6 +535,7 @@ attach(CQTileArea::Side side, int row1, int col1, int row2, int col2, bool previ
 
       if (! area) { // assert ?
         std::cerr << "no area at " << row1 << " " << col1 << std::endl;
+        area_->endUndoStep();
         return;
       }
 
@@ -526,6 +573,8 @@ attach(CQTileArea::Side side, int row1, int col1, int row2, int col2, bool previ
   if (! preview) {
     setDetached(false);
     setFloating(false);
+
+    area_->endUndoStep();
   }
 }
 
@@ -733,6 +782,9 @@ createContextMenu(QWidget *parent) const
   auto *restoreAction  = menu->addAction(QPixmap(restore_data ), "Restore");
   auto *tileAction     = menu->addAction(QPixmap(tile_data    ), "Tile");
   (void)                 menu->addSeparator();
+  auto *undoAction     = menu->addAction("Undo Layout");
+  auto *redoAction     = menu->addAction("Redo Layout");
+  (void)                 menu->addSeparator();
   auto *closeAction    = menu->addAction(QPixmap(close_data   ), "Close");
 
   connect(detachAction  , SIGNAL(triggered()), this, SLOT(detachSlot()));
@@ -740,6 +792,8 @@ createContextMenu(QWidget *parent) const
   connect(maximizeAction, SIGNAL(triggered()), this, SLOT(maximizeSlot()));
   connect(restoreAction , SIGNAL(triggered()), this, SLOT(restoreSlot()));
   connect(tileAction    , SIGNAL(triggered()), this, SLOT(tileSlot()));
+  connect(undoAction    , SIGNAL(triggered()), area_, SLOT(undoSlot()));
+  connect(redoAction    , SIGNAL(triggered()), area_, SLOT(redoSlot()));
   connect(closeAction   , SIGNAL(triggered()), this, SLOT(closeSlot()));
 
   return menu;
@@ -767,6 +821,10 @@ updateContextMenu(QMenu *menu) const
       action->setVisible(  isMaximized());
       action->setEnabled(area_->isRestoreStateValid());
     }
+    else if (text == "Undo Layout")
+      action->setEnabled(area_->canUndo());
+    else if (text == "Redo Layout")
+      action->setEnabled(area_->canRedo());
   }
 }
 
@@ -194,9 +194,6 @@ mouseMoveEvent(QMouseEvent *e)
     area_->doAttachPreview();
   else
     area_->area()->setHighlight(mouseState_.pressPos);
-
-  // redraw
-  area_->area()->update();
 }
 
 // handle mouse release
@@ -0,0 +1,234 @@
+#include <CTileConstraintSolver.h>
+
+#include <algorithm>
+#include <climits>
+
+// remove all variables and constraints
+void
+CTileConstraintSolver::
+clear()
+{
+  vars_       .clear();
+  constraints_.clear();
+  varCons_    .clear();
+}
+
+// add variable
+int
+CTileConstraintSolver::
+addVariable(int pref)
+{
+  Variable var;
+
+  var.pref = pref;
+  var.pos  = pref;
+
+  vars_   .push_back(var);
+  varCons_.push_back(Indices());
+
+  return int(vars_.size() - 1);
+}
+
+// fix variable position
+void
+CTileConstraintSolver::
+setFixed(int i, int pos, bool weak)
+{
+  Variable &var = vars_[uint(i)];
+
+  var.fixed    = true;
+  var.weak     = weak;
+  var.fixedPos = pos;
+}
+
+// add constraint pos[j] - pos[i] >= d
+void
+CTileConstraintSolver::
+addMinDistance(int i, int j, int d)
+{
+  Constraint constraint;
+
+  constraint.i = i;
+  constraint.j = j;
+  constraint.d = d;
+
+  int ic = int(constraints_.size());
+
+  constraints_.push_back(constraint);
+
+  varCons_[uint(i)].push_back(ic);
+  varCons_[uint(j)].push_back(ic);
+}
+
+// add constraint pos[j] - pos[i] <= d (stored as pos[i] - pos[j] >= -d)
+void
+CTileConstraintSolver::
+addMaxDistance(int i, int j, int d)
+{
+  Constraint constraint;
+
+  constraint.i        = j;
+  constraint.j        = i;
+  constraint.d        = -d;
+  constraint.optional = true;
+
+  int ic = int(constraints_.size());
+
+  constraints_.push_back(constraint);
+
+  varCons_[uint(i)].push_back(ic);
+  varCons_[uint(j)].push_back(ic);
+}
+
+// solve positions relaxing constraints until they can be met
+bool
+CTileConstraintSolver::
+solve()
+{
+  if (solveStage(Stage::ALL))
+    return true;
+
+  if (solveStage(Stage::NO_OPTIONAL))
+    return false;
+
+  if (solveStage(Stage::NO_WEAK))
+    return false;
+
+  // inconsistent required constraints (use preferred positions)
+  for (auto &var : vars_)
+    var.pos = (var.fixed ? var.fixedPos : var.pref);
+
+  return false;
+}
+
+// solve positions for stage
+bool
+CTileConstraintSolver::
+solveStage(Stage stage)
+{
+  uint nv = uint(vars_.size());
+
+  lo_.assign(nv, INT_MIN);
+  hi_.assign(nv, INT_MAX);
+
+  work_.clear();
+
+  inWork_.assign(nv, false);
+
+  // set bounds of fixed variables and propagate
+  for (uint i = 0; i < nv; ++i) {
+    const Variable &var = vars_[i];
+
+    if (! var.fixed)
+      continue;
+
+    lo_[i] = var.fixedPos;
+
+    if (! var.weak || stage != Stage::NO_WEAK)
+      hi_[i] = var.fixedPos;
+
+    addWork(int(i));
+  }
+
+  if (! propagate(stage))
+    return false;
+
+  // set each variable (in order) to preferred position in bounds and propagate
+  for (uint i = 0; i < nv; ++i) {
+    if (lo_[i] == hi_[i])
+      continue;
+
+    int pos = vars_[i].pref;
+
+    // weak fixed position (without upper bound) stays at lowest position
+    if (vars_[i].fixed)
+      pos = lo_[i];
+
+    pos = std::min(std::max(pos, lo_[i]), hi_[i]);
+
+    lo_[i] = pos;
+    hi_[i] = pos;
+
+    addWork(int(i));
+
+    if (! propagate(stage))
+      return false;
+  }
+
+  for (uint i = 0; i < nv; ++i)
+    vars_[i].pos = lo_[i];
+
+  return true;
+}
+
+// propagate lower/upper bounds through constraints (Bellman-Ford on work list)
+bool
+CTileConstraintSolver::
+propagate(Stage stage)
+{
+  // more updates than this means a cycle with a positive length (inconsistent)
+  long maxUpdates = long(vars_.size() + 1)*long(constraints_.size() + 1);
+  long numUpdates = 0;
+
+  uint iw = 0;
+
+  while (iw < work_.size()) {
+    int k = work_[iw++];
+
+    inWork_[uint(k)] = false;
+
+    for (int ic : varCons_[uint(k)]) {
+      const Constraint &constraint = constraints_[uint(ic)];
+
+      if (constraint.optional && stage != Stage::ALL)
+        continue;
+
+      uint i = uint(constraint.i);
+      uint j = uint(constraint.j);
+
+      // pos[j] >= pos[i] + d
+      if (lo_[i] != INT_MIN && lo_[i] + constraint.d > lo_[j]) {
+        lo_[j] = lo_[i] + constraint.d;
+
+        if (lo_[j] > hi_[j])
+          return false;
+
+        addWork(int(j));
+
+        ++numUpdates;
+      }
+
+      // pos[i] <= pos[j] - d
+      if (hi_[j] != INT_MAX && hi_[j] - constraint.d < hi_[i]) {
+        hi_[i] = hi_[j] - constraint.d;
+
+        if (lo_[i] > hi_[i])
+          return false;
+
+        addWork(int(i));
+
+        ++numUpdates;
+      }
+
+      if (numUpdates > maxUpdates)
+        return false;
+    }
+  }
+
+  work_.clear();
+
+  return true;
+}
+
+// add variable to work list (if not already in list)
+void
+CTileConstraintSolver::
+addWork(int i)
+{
+  if (inWork_[uint(i)])
+    return;
+
+  inWork_[uint(i)] = true;
+
+  work_.push_back(i);
+}
@@ -1,326 +1,912 @@
 #include <CTileGrid.h>
-#include <set>
+#include <algorithm>
+#include <deque>
+#include <limits>
 
-// add new rows after specified row
-void
-CTileGrid::
-insertRows(int row, int nrows)
+// replace old index with new index
+template<typename CELL, int N>
+bool
+CTileGridT<CELL, N>::
+replace(int oldId, int newId)
 {
-  // save old rows and cols
-  CTileGrid grid = *this;
+  if (oldId == newId)
+    return true;
 
-  // calc new cell grid
-  int nrows1 = nrows_ + nrows;
-  int ncols1 = std::max(ncols_, 1);
+  int oldV = findValue(oldId);
 
-  setSize(nrows1, ncols1);
+  if (oldV < -1 || areaInfo(oldV).count == 0)
+    return true;
 
-  clear();
+  // if new id not in grid then change is undone by replacing new id with old id
+  bool newExists = (newId == -1 ? areaInfo(-1).count > 0 : findValue(newId) >= -1);
 
-  // populate new grid with old either side of the new rows
-  for (int r = 0; r < nrows1; ++r) {
-    for (int c = 0; c < ncols1; ++c) {
-      int &pc = cell(r, c);
+  // if new id not in grid then just rename value of old id (except empty)
+  if (oldV >= 0 && newId != -1 && ! newExists) {
+    eraseIdValue(oldId);
+
+    ids_[uint(oldV)] = newId;
+
+    setIdValue(newId, oldV);
+
+    if (record_.changes) {
+      Change &change = record_.changes->add(Change::Type::REPLACE);
+
+      change.id1 = oldId;
+      change.id2 = newId;
+    }
+
+    changed();
+
+    return true;
+  }
+
+  int newV = idValue(newId);
+
+  if (newV < -1)
+    return false;
+
+  if (record_.changes && ! newExists) {
+    Change &change = record_.changes->add(Change::Type::REPLACE);
+
+    change.id1 = oldId;
+    change.id2 = newId;
+  }
+
+  // otherwise each changed cell is recorded
+  Changes *changes = (! newExists ? nullptr : record_.changes);
+
+  // only cells in bounding box of old id need to be checked
+  updateAreas();
+
+  AreaInfo info = areaInfo(oldV);
+
+  areaInfo(oldV) = AreaInfo();
+
+  freeValue(oldV);
+
+  int n = info.c2 - info.c1 + 1;
+
+  Cell oldCell = Cell(oldV);
+  Cell newCell = Cell(newV);
+
+  for (int r = info.r1; r <= info.r2; ++r) {
+    Cell *cells = cells_.data() + r*ncols_ + info.c1;
+
+    Hash rowToken = rowToken_[uint(r)];
+    Hash colDelta = cellHash(newV, rowToken) - cellHash(oldV, rowToken);
+
+    // skip to each run of matching cells and overwrite run
+    for (int i = int(std::find(cells, cells + n, oldCell) - cells); i < n; ) {
+      int i1 = i;
 
-      if      (r < row)
-        pc = grid.cell(r, c);
-      else if (r > row)
-        pc = grid.cell(r - nrows, c);
+      for ( ; i1 < n && cells[i1] == oldCell; ++i1) {
+        int c = info.c1 + i1;
+
+        if (changes)
+          changes->addCell(r*ncols_ + c, oldId, newId);
+
+        Hash colToken = colToken_[uint(c)];
+
+        rowHash_[uint(r)] += cellHash(newV, colToken) - cellHash(oldV, colToken);
+        colHash_[uint(c)] += colDelta;
+      }
+
+      std::fill(cells + i, cells + i1, newCell);
+
+      i = int(std::find(cells + i1, cells + n, oldCell) - cells);
     }
   }
 
-  // ensure no areas are split
-  if (row > 0 && row < nrows1 - 1) {
-    for (int c = 0; c < ncols1; ++c) {
-      if (cell(row - 1, c) == cell(row + 1, c))
-        cell(row, c) = cell(row - 1, c);
+  // move old id cells to new id
+  addAreaCells(newV, info.r1, info.c1, info.r2, info.c2, info.count);
+
+  changed();
+
+  return true;
+}
+
+// clear to index
+template<typename CELL, int N>
+void
+CTileGridT<CELL, N>::
+clear(int ind)
+{
+  Change *change = beginResize();
+
+  // single id in grid
+  areas_.clear();
+
+  areasShrunk_ = false;
+
+  ids_       .clear();
+  idValues_  .clear();
+  freeValues_.clear();
+
+  if (nrows_*ncols_ == 0) {
+    endResize(change);
+    return;
+  }
+
+  int v = idValue(ind);
+
+  std::fill(cells_.data(), cells_.data() + nrows_*ncols_, Cell(v));
+
+  // all rows (and all columns) have same hash
+  Hash rowHash = 0, colHash = 0;
+
+  for (int c = 0; c < ncols_; ++c) rowHash += cellHash(v, colToken_[uint(c)]);
+  for (int r = 0; r < nrows_; ++r) colHash += cellHash(v, rowToken_[uint(r)]);
+
+  rowHash_.assign(uint(nrows_), rowHash);
+  colHash_.assign(uint(ncols_), colHash);
+
+  addAreaCells(v, 0, 0, nrows_ - 1, ncols_ - 1, nrows_*ncols_);
+
+  endResize(change);
+}
+
+// fill range with index
+template<typename CELL, int N>
+bool
+CTileGridT<CELL, N>::
+fill(int r1, int c1, int r2, int c2, int id)
+{
+  if (r1 > r2 || c1 > c2)
+    return true;
+
+  int v = idValue(id);
+
+  if (v < -1)
+    return false;
+
+  int n = c2 - c1 + 1;
+
+  // hash of new value for each column
+  Hashes valueHash(uint(n), 0);
+
+  for (int i = 0; i < n; ++i)
+    valueHash[uint(i)] = cellHash(v, colToken_[uint(c1 + i)]);
+
+  int nchanged = 0;
+
+  for (int r = r1; r <= r2; ++r) {
+    Cell *cells = cells_.data() + r*ncols_ + c1;
+
+    Hash rowToken     = rowToken_[uint(r)];
+    Hash rowValueHash = cellHash(v, rowToken);
+
+    // update hashes and area index for each run of changed cells with same value
+    for (int i = 0; i < n; ) {
+      int oldV = cells[i];
+
+      int i1 = i + 1;
+
+      while (i1 < n && cells[i1] == oldV)
+        ++i1;
+
+      if (oldV != v) {
+        for (int i2 = i; i2 < i1; ++i2) {
+          int c = c1 + i2;
+
+          if (record_.changes)
+            record_.changes->addCell(r*ncols_ + c, valueId(oldV), id);
+
+          rowHash_[uint(r)] += valueHash[uint(i2)] - cellHash(oldV, colToken_[uint(c)]);
+          colHash_[uint(c)] += rowValueHash        - cellHash(oldV, rowToken);
+        }
+
+        removeAreaCells(oldV, r, c1 + i, c1 + i1 - 1);
+
+        nchanged += i1 - i;
+      }
+
+      i = i1;
     }
+
+    std::fill(cells, cells + n, Cell(v));
+  }
+
+  if (nchanged > 0) {
+    addAreaCells(v, r1, c1, r2, c2, nchanged);
+
+    changed();
   }
+
+  return true;
+}
+
+// add new rows after specified row
+template<typename CELL, int N>
+void
+CTileGridT<CELL, N>::
+insertRows(int row, int nrows)
+{
+  insert(Inserts { Insert(row, nrows) }, Inserts());
 }
 
 // add new columns after specified column
+template<typename CELL, int N>
 void
-CTileGrid::
+CTileGridT<CELL, N>::
 insertColumns(int col, int ncols)
 {
-  // save old rows and cols
-  CTileGrid grid = *this;
+  insert(Inserts(), Inserts { Insert(col, ncols) });
+}
+
+// insert rows and columns in a single pass.
+// Insert positions are old row/column numbers and new rows/columns are
+// added before the old row/column at that position.
+template<typename CELL, int N>
+void
+CTileGridT<CELL, N>::
+insert(const Inserts &rowInserts, const Inserts &colInserts)
+{
+  // get number of new rows/columns before each old row/column (and at end)
+  std::vector<int> rowShift, colShift;
+
+  int nr = CTileGridTypes::calcShift(rowInserts, nrows_, rowShift);
+  int nc = CTileGridTypes::calcShift(colInserts, ncols_, colShift);
+
+  if (nr == 0 && nc == 0)
+    return;
+
+  // ensure at least one row/column
+  if (nrows_ + nr == 0) nr = CTileGridTypes::calcShift(Inserts { Insert(0, 1) }, 0, rowShift);
+  if (ncols_ + nc == 0) nc = CTileGridTypes::calcShift(Inserts { Insert(0, 1) }, 0, colShift);
+
+  int nrows1 = nrows_;
+  int ncols1 = ncols_;
 
-  // calc new cell grid
-  int nrows1 = std::max(nrows_, 1);
-  int ncols1 = ncols_ + ncols;
+  int nrows2 = nrows1 + nr;
+  int ncols2 = ncols1 + nc;
+
+  auto rowMap = [&](int r) { return r + rowShift[uint(r)]; };
+  auto colMap = [&](int c) { return c + colShift[uint(c)]; };
+
+  //---
+
+  // move old cells to new positions in place, last row first and right to left
+  // in each row so cells are never overwritten before they are moved.
+  // Rows are moved in blocks of columns with no inserted columns between them.
+  cells_.resize(uint(nrows2*ncols2));
+
+  for (int r = nrows1 - 1; r >= 0; --r) {
+    Cell *cells1 = cells_.data() + r*ncols1;
+    Cell *cells2 = cells_.data() + rowMap(r)*ncols2;
+
+    int c2 = ncols1;
+
+    while (c2 > 0) {
+      int c1 = c2 - 1;
+
+      while (c1 > 0 && colShift[uint(c1)] == colShift[uint(c1 - 1)])
+        --c1;
+
+      std::copy_backward(cells1 + c1, cells1 + c2, cells2 + colMap(c2 - 1) + 1);
+
+      c2 = c1;
+    }
+  }
+
+  //---
 
-  setSize(nrows1, ncols1);
+  // set new columns in old rows (extend areas which span the column)
+  std::vector<bool> newRow(uint(nrows2), true), newCol(uint(ncols2), true);
 
-  clear();
+  for (int r = 0; r < nrows1; ++r) newRow[uint(rowMap(r))] = false;
+  for (int c = 0; c < ncols1; ++c) newCol[uint(colMap(c))] = false;
+
+  // insert is undone by removing new rows and columns
+  if (record_.changes) {
+    Change &change = record_.changes->add(Change::Type::INSERT);
+
+    change.rowInserts = rowInserts;
+    change.colInserts = colInserts;
+    change.rows       = newRow;
+    change.cols       = newCol;
+  }
 
-  // populate new grid with old either side of the new columns
   for (int r = 0; r < nrows1; ++r) {
-    for (int c = 0; c < ncols1; ++c) {
-      int &pc = cell(r, c);
+    Cell *cells2 = cells_.data() + rowMap(r)*ncols2;
+
+    for (int c = 0; c <= ncols1; ++c) {
+      int n = colShift[uint(c)] - (c > 0 ? colShift[uint(c - 1)] : 0);
+      if (n == 0) continue;
+
+      Cell v = -1;
+
+      if (c > 0 && c < ncols1 && cells2[colMap(c - 1)] == cells2[colMap(c)])
+        v = cells2[colMap(c)];
+
+      std::fill(cells2 + colMap(c) - n, cells2 + colMap(c), v);
+    }
+  }
+
+  // set new rows (extend areas which span the row)
+  for (int r = 0; r <= nrows1; ++r) {
+    int n = rowShift[uint(r)] - (r > 0 ? rowShift[uint(r - 1)] : 0);
+    if (n == 0) continue;
+
+    int r2 = (r < nrows1 ? rowMap(r) : nrows2);
 
-      if      (c < col)
-        pc = grid.cell(r, c);
-      else if (c > col)
-        pc = grid.cell(r, c - ncols);
+    const Cell *cellsA = (r > 0 && r < nrows1 ? cells_.data() + rowMap(r - 1)*ncols2 : nullptr);
+    const Cell *cellsB = (r > 0 && r < nrows1 ? cells_.data() + r2*ncols2 : nullptr);
+
+    for (int r1 = r2 - n; r1 < r2; ++r1) {
+      Cell *cells1 = cells_.data() + r1*ncols2;
+
+      for (int c = 0; c < ncols2; ++c)
+        cells1[c] = (cellsA && cellsA[c] == cellsB[c] ? cellsA[c] : Cell(-1));
     }
   }
 
-  // ensure no areas are split
-  if (col > 0 && col < ncols1 - 1) {
-    for (int r = 0; r < nrows1; ++r) {
-      if (cell(r, col - 1) == cell(r, col + 1))
-        cell(r, col) = cell(r, col - 1);
+  //---
+
+  // update hashes for new cells (new tokens for new rows and columns)
+  Hashes rowHash(uint(nrows2), 0), rowToken(uint(nrows2), 0);
+  Hashes colHash(uint(ncols2), 0), colToken(uint(ncols2), 0);
+
+  for (int r = 0; r < nrows1; ++r) {
+    rowHash [uint(rowMap(r))] = rowHash_ [uint(r)];
+    rowToken[uint(rowMap(r))] = rowToken_[uint(r)];
+  }
+
+  for (int c = 0; c < ncols1; ++c) {
+    colHash [uint(colMap(c))] = colHash_ [uint(c)];
+    colToken[uint(colMap(c))] = colToken_[uint(c)];
+  }
+
+  for (int r = 0; r < nrows2; ++r) if (newRow[uint(r)]) rowToken[uint(r)] = newToken();
+  for (int c = 0; c < ncols2; ++c) if (newCol[uint(c)]) colToken[uint(c)] = newToken();
+
+  // move area bounding boxes with old cells
+  std::vector<int> rowMap1(uint(nrows1), 0), colMap1(uint(ncols1), 0);
+
+  for (int r = 0; r < nrows1; ++r) rowMap1[uint(r)] = rowMap(r);
+  for (int c = 0; c < ncols1; ++c) colMap1[uint(c)] = colMap(c);
+
+  remapAreas(rowMap1, colMap1);
+
+  // new rows and columns have no size
+  rowEdges_.insert(rowShift, nrows2);
+  colEdges_.insert(colShift, ncols2);
+
+  for (int r = 0; r < nrows2; ++r) {
+    for (int c = 0; c < ncols2; ++c) {
+      if (! newRow[uint(r)] && ! newCol[uint(c)]) continue;
+
+      int v = cells_[uint(r*ncols2 + c)];
+
+      rowHash[uint(r)] += cellHash(v, colToken[uint(c)]);
+      colHash[uint(c)] += cellHash(v, rowToken[uint(r)]);
+
+      addAreaCell(v, r, c);
     }
   }
+
+  nrows_ = nrows2;
+  ncols_ = ncols2;
+
+  rowHash_ .swap(rowHash);
+  rowToken_.swap(rowToken);
+  colHash_ .swap(colHash);
+  colToken_.swap(colToken);
+
+  changed();
 }
 
 // expand occupied cells to fill empty ones
-bool
-CTileGrid::
+template<typename CELL, int N>
+typename CTileGridT<CELL, N>::FillResult
+CTileGridT<CELL, N>::
 fillEmptyCells()
 {
   // TODO: remove empty rows/cols
 
-  // save original grid
-  CTileGrid grid = *this;
+  FillResult result;
+
+  // split empty cells into rectangular regions (single scan of grid)
+  std::deque<Region> regions;
+
+  uint ncells = uint(nrows_*ncols_);
+
+  std::vector<bool> used;
+
+  for (uint i = 0; i < ncells; ++i) {
+    if (valueId(cells_[i]) >= 0 || (! used.empty() && used[i]))
+      continue;
+
+    if (used.empty())
+      used.resize(ncells);
+
+    int r1 = int(i) / ncols_;
+    int c1 = int(i) % ncols_;
+
+    auto isEmpty = [&](int r, int c) {
+      uint ind = uint(r*ncols_ + c);
+
+      return (valueId(cells_[ind]) < 0 && ! used[ind]);
+    };
+
+    // extend right then down while whole row span is empty
+    int c2 = c1;
 
-  uint ncells = uint(nrows()*ncols());
+    while (c2 + 1 < ncols_ && isEmpty(r1, c2 + 1))
+      ++c2;
 
-  bool failed = false;
+    int r2 = r1;
 
-  while (! failed) {
-    // find empty cell
-    uint i = 0;
+    while (r2 + 1 < nrows_) {
+      bool empty = true;
 
-    for ( ; i < ncells; ++i)
-      if (cells_[i] < 0)
+      for (int c = c1; empty && c <= c2; ++c)
+        empty = isEmpty(r2 + 1, c);
+
+      if (! empty)
         break;
 
-    if (i >= ncells)
-      break;
+      ++r2;
+    }
+
+    for (int r = r1; r <= r2; ++r)
+      for (int c = c1; c <= c2; ++c)
+        used[uint(r*ncols_ + c)] = true;
 
-    int r = int(int(i) / ncols());
-    int c = int(int(i) % ncols());
+    regions.push_back(Region(r1, c1, r2, c2));
+  }
+
+  if (regions.empty())
+    return result;
+
+  //---
 
-    int id = cell(r, c);
+  // fill each empty region from a neighbour, regions which can't be filled yet
+  // are retried when a touching region is filled
+  std::vector<Region> pending;
 
-    // get empty cell region
-    int nr = 1, nc = 1;
+  Journal journal;
 
-    getRegion(id, r, c, &nr, &nc);
+  while (! regions.empty()) {
+    Region region = regions.front();
 
-    int r2 = r + nr - 1;
-    int c2 = c + nc - 1;
+    regions.pop_front();
 
     // fill based on major direction
-    if (nr > nc) {
-      if (r  > 0          && fillTop   (r  - 1, c, c2)) { /* print(std::cerr); */ continue; }
-      if (r2 < nrows_ - 1 && fillBottom(r2 + 1, c, c2)) { /* print(std::cerr); */ continue; }
-      if (c  > 0          && fillLeft  (c  - 1, r, r2)) { /* print(std::cerr); */ continue; }
-      if (c2 < ncols_ - 1 && fillRight (c2 + 1, r, r2)) { /* print(std::cerr); */ continue; }
-    }
-    else {
-      if (c  > 0          && fillLeft  (c  - 1, r, r2)) { /* print(std::cerr); */ continue; }
-      if (c2 < ncols_ - 1 && fillRight (c2 + 1, r, r2)) { /* print(std::cerr); */ continue; }
-      if (r  > 0          && fillTop   (r  - 1, c, c2)) { /* print(std::cerr); */ continue; }
-      if (r2 < nrows_ - 1 && fillBottom(r2 + 1, c, c2)) { /* print(std::cerr); */ continue; }
+    static const int majorRow[] = { 2, 3, 0, 1 };
+    static const int majorCol[] = { 0, 1, 2, 3 };
+
+    const int *sides = (region.nrows() > region.ncols() ? majorRow : majorCol);
+
+    bool filled = false;
+
+    for (int i = 0; ! filled && i < 4; ++i)
+      filled = fillSide(region, sides[i], journal);
+
+    if (! filled) {
+      pending.push_back(region);
+      continue;
     }
 
-    // no change so fail
-    failed = true;
+    // requeue pending regions touching filled region
+    for (auto p = pending.begin(); p != pending.end(); ) {
+      if ((*p).touches(region)) {
+        regions.push_back(*p);
+
+        p = pending.erase(p);
+      }
+      else
+        ++p;
+    }
   }
 
-  // if failed restore original grid
-  if (failed) {
-    print(std::cerr);
+  // if failed restore original cells from journal
+  if (! pending.empty()) {
+    for (auto p = journal.rbegin(); p != journal.rend(); ++p)
+      setValue(int((*p).first) / ncols_, int((*p).first) % ncols_, idValue((*p).second));
+
+    const Region *first = nullptr;
+
+    for (const auto &region : pending) {
+      if (! first || region.r1 < first->r1 ||
+          (region.r1 == first->r1 && region.c1 < first->c1))
+        first = &region;
+    }
+
+    result.failed   = true;
+    result.numEmpty = int(pending.size());
+    result.row1     = first->r1;
+    result.col1     = first->c1;
+    result.row2     = first->r2;
+    result.col2     = first->c2;
+
+    return result;
+  }
 
-    *this = grid;
+  // record filled (previously empty) cells
+  if (record_.changes) {
+    for (const auto &entry : journal)
+      record_.changes->addCell(int(entry.first), entry.second, cell(int(entry.first)));
   }
 
-  return failed;
+  if (! journal.empty())
+    changed();
+
+  return result;
 }
 
-// fill columns to left of column and row range
+// fill empty region from cells on side (0=left, 1=right, 2=top, 3=bottom)
+// fails if side cells are empty or their areas extend beyond the region
+template<typename CELL, int N>
 bool
-CTileGrid::
-fillLeft(int c, int r1, int r2)
+CTileGridT<CELL, N>::
+fillSide(const Region &region, int side, Journal &journal)
 {
-  if (r1 > 0          && cell(r1 - 1, c) == cell(r1, c)) return false;
-  if (r2 < nrows_ - 1 && cell(r2 + 1, c) == cell(r2, c)) return false;
+  int r1 = region.r1, c1 = region.c1;
+  int r2 = region.r2, c2 = region.c2;
 
-  for (int r = r1; r <= r2; ++r)
-    cell(r, c + 1) = cell(r, c);
+  if (side == 0 || side == 1) {
+    // get source column
+    int c = (side == 0 ? c1 - 1 : c2 + 1);
 
-  return true;
-}
+    if (c < 0 || c >= ncols_)
+      return false;
 
-// fill columns to right of column and row range
-bool
-CTileGrid::
-fillRight(int c, int r1, int r2)
-{
-  if (r1 > 0          && cell(r1 - 1, c) == cell(r1, c)) return false;
-  if (r2 < nrows_ - 1 && cell(r2 + 1, c) == cell(r2, c)) return false;
+    for (int r = r1; r <= r2; ++r)
+      if (cell(r, c) < 0) return false;
 
-  for (int r = r1; r <= r2; ++r)
-    cell(r, c - 1) = cell(r, c);
+    if (r1 > 0          && cell(r1 - 1, c) == cell(r1, c)) return false;
+    if (r2 < nrows_ - 1 && cell(r2 + 1, c) == cell(r2, c)) return false;
 
-  return true;
-}
+    for (int r = r1; r <= r2; ++r) {
+      int v = cells_[uint(r*ncols_ + c)];
 
-// fill columns above row and column range
-bool
-CTileGrid::
-fillTop(int r, int c1, int c2)
-{
-  if (c1 > 0          && cell(r, c1 - 1) == cell(r, c1)) return false;
-  if (c2 < ncols_ - 1 && cell(r, c2 + 1) == cell(r, c2)) return false;
+      for (int c3 = c1; c3 <= c2; ++c3) {
+        journal.push_back(JournalEntry(uint(r*ncols_ + c3), cell(r, c3)));
 
-  for (int c = c1; c <= c2; ++c)
-    cell(r + 1, c) = cell(r, c);
+        setValue(r, c3, v);
+      }
+    }
+  }
+  else {
+    // get source row
+    int r = (side == 2 ? r1 - 1 : r2 + 1);
 
-  return true;
-}
+    if (r < 0 || r >= nrows_)
+      return false;
 
-// fill columns below row and column range
-bool
-CTileGrid::
-fillBottom(int r, int c1, int c2)
-{
-  if (c1 > 0          && cell(r, c1 - 1) == cell(r, c1)) return false;
-  if (c2 < ncols_ - 1 && cell(r, c2 + 1) == cell(r, c2)) return false;
+    for (int c = c1; c <= c2; ++c)
+      if (cell(r, c) < 0) return false;
+
+    if (c1 > 0          && cell(r, c1 - 1) == cell(r, c1)) return false;
+    if (c2 < ncols_ - 1 && cell(r, c2 + 1) == cell(r, c2)) return false;
 
-  for (int c = c1; c <= c2; ++c)
-    cell(r - 1, c) = cell(r, c);
+    for (int r3 = r1; r3 <= r2; ++r3) {
+      for (int c = c1; c <= c2; ++c) {
+        journal.push_back(JournalEntry(uint(r3*ncols_ + c), cell(r3, c)));
+
+        setValue(r3, c, cells_[uint(r*ncols_ + c)]);
+      }
+    }
+  }
 
   return true;
 }
 
 // remove duplicate rows
+template<typename CELL, int N>
 void
-CTileGrid::
+CTileGridT<CELL, N>::
 removeDuplicateRows()
 {
-  std::set<int> rows;
+  if (nrows_ <= 1)
+    return;
 
-  // check if each row matches previous one
-  for (int r = 1; r < nrows_; ++r) {
-    bool match = true;
+  // compare each row with last kept row (hash first)
+  std::vector<bool> removed(uint(nrows_), false);
 
-    for (int c = 0; c < ncols_; ++c) {
-      if (cell(r - 1, c) != cell(r, c)) {
-        match = false;
-        break;
-      }
-    }
+  int nremoved = 0;
+
+  for (int r = 1, r1 = 0; r < nrows_; ++r) {
+    if (rowHash_[uint(r)] == rowHash_[uint(r1)] && rowsEqual(r, r1)) {
+      removed[uint(r)] = true;
 
-    if (match)
-      rows.insert(r);
+      ++nremoved;
+    }
+    else
+      r1 = r;
   }
 
-  if (rows.empty())
-    return;
+  if (nremoved > 0)
+    removeRows(removed);
+}
 
-  //---
+// remove duplicate columns
+template<typename CELL, int N>
+void
+CTileGridT<CELL, N>::
+removeDuplicateCols()
+{
+  if (ncols_ <= 1)
+    return;
 
-  // remove each duplicate row
-  CTileGrid grid(nrows_ - int(rows.size()), ncols_);
+  // compare each column with last kept column (hash first)
+  std::vector<bool> removed(uint(ncols_), false);
 
-  for (int r = 0, r1 = 0; r < nrows_; ++r) {
-    if (rows.find(r) != rows.end()) continue;
+  int nremoved = 0;
 
-    for (int c = 0; c < ncols_; ++c)
-      grid.cell(r1, c) = cell(r, c);
+  for (int c = 1, c1 = 0; c < ncols_; ++c) {
+    if (colHash_[uint(c)] == colHash_[uint(c1)] && colsEqual(c, c1)) {
+      removed[uint(c)] = true;
 
-    ++r1;
+      ++nremoved;
+    }
+    else
+      c1 = c;
   }
 
-  *this = grid;
+  if (nremoved > 0)
+    removeCols(removed);
 }
 
-// remove duplicate columns
+// remove rows with removed flag set and compact kept rows in place
+template<typename CELL, int N>
 void
-CTileGrid::
-removeDuplicateCols()
+CTileGridT<CELL, N>::
+removeRows(const std::vector<bool> &removed)
 {
-  std::set<int> cols;
+  auto isRemoved = [&](int r) { return (uint(r) < removed.size() && removed[uint(r)]); };
 
-  // check if each column matches previous one
-  for (int c = 1; c < ncols_; ++c) {
-    bool match = true;
+  Change *change = nullptr;
 
-    for (int r = 0; r < nrows_; ++r) {
-      if (cell(r, c - 1) != cell(r, c)) {
-        match = false;
-        break;
+  // removed rows map to the kept row above (or first kept row)
+  std::vector<int> rowMap(uint(nrows_), 0);
+
+  int r1 = 0;
+
+  for (int r = 0; r < nrows_; ++r) {
+    if (isRemoved(r)) {
+      if (record_.changes && ! change) {
+        change = &record_.changes->add(Change::Type::REMOVE);
+
+        change->rows = removed;
+
+        change->rows.resize(uint(nrows_), false);
       }
+
+      // remove row cells from column hashes and area index (row is not yet overwritten)
+      for (int c = 0; c < ncols_; ++c) {
+        int v = cells_[uint(r*ncols_ + c)];
+
+        if (change)
+          change->ids1.push_back(valueId(v));
+
+        colHash_[uint(c)] -= cellHash(v, rowToken_[uint(r)]);
+
+        removeAreaCell(v, r, c);
+      }
+
+      rowMap[uint(r)] = std::max(r1 - 1, 0);
+
+      continue;
     }
 
-    if (match)
-      cols.insert(c);
+    rowMap[uint(r)] = r1;
+
+    if (r1 != r) {
+      std::copy(cells_.data() + r*ncols_, cells_.data() + r*ncols_ + ncols_,
+                cells_.data() + r1*ncols_);
+
+      rowHash_ [uint(r1)] = rowHash_ [uint(r)];
+      rowToken_[uint(r1)] = rowToken_[uint(r)];
+    }
+
+    ++r1;
   }
 
-  if (cols.empty())
+  if (r1 == nrows_)
+    return;
+
+  remapAreas(rowMap, std::vector<int>());
+
+  rowEdges_.erase(removed);
+
+  nrows_ = r1;
+
+  cells_   .resize(uint(nrows_*ncols_));
+  rowHash_ .resize(uint(nrows_));
+  rowToken_.resize(uint(nrows_));
+
+  changed();
+}
+
+// remove columns with removed flag set and compact each row in place
+template<typename CELL, int N>
+void
+CTileGridT<CELL, N>::
+removeCols(const std::vector<bool> &removed)
+{
+  auto isRemoved = [&](int c) { return (uint(c) < removed.size() && removed[uint(c)]); };
+
+  int nremoved = 0;
+
+  for (int c = 0; c < ncols_; ++c)
+    if (isRemoved(c)) ++nremoved;
+
+  if (nremoved == 0)
     return;
 
-  // remove each duplicate column
-  CTileGrid grid(nrows_, ncols_ - int(cols.size()));
+  Change *change = nullptr;
+
+  if (record_.changes) {
+    change = &record_.changes->add(Change::Type::REMOVE);
+
+    change->cols = removed;
+
+    change->cols.resize(uint(ncols_), false);
+
+    // removed cells are stored by column
+    for (int c = 0; c < ncols_; ++c) {
+      if (! isRemoved(c)) continue;
+
+      for (int r = 0; r < nrows_; ++r)
+        change->ids1.push_back(cell(r, c));
+    }
+  }
+
+  //---
+
+  // compact each row in place (new row start is never after old one)
+  int ncols1 = ncols_ - nremoved;
+
+  for (int r = 0; r < nrows_; ++r) {
+    uint i1 = uint(r*ncols1);
+
+    for (int c = 0; c < ncols_; ++c) {
+      Cell v = cells_[uint(r*ncols_ + c)];
+
+      if (isRemoved(c)) {
+        rowHash_[uint(r)] -= cellHash(v, colToken_[uint(c)]);
+
+        removeAreaCell(v, r, c);
+      }
+      else
+        cells_[i1++] = v;
+    }
+  }
+
+  // removed columns map to the kept column to the left (or first kept column)
+  std::vector<int> colMap(uint(ncols_), 0);
 
   for (int c = 0, c1 = 0; c < ncols_; ++c) {
-    if (cols.find(c) != cols.end()) continue;
+    if (isRemoved(c)) {
+      colMap[uint(c)] = std::max(c1 - 1, 0);
+      continue;
+    }
+
+    colMap[uint(c)] = c1;
 
-    for (int r = 0; r < nrows_; ++r)
-      grid.cell(r, c1) = cell(r, c);
+    colHash_ [uint(c1)] = colHash_ [uint(c)];
+    colToken_[uint(c1)] = colToken_[uint(c)];
 
     ++c1;
   }
 
-  *this = grid;
+  remapAreas(std::vector<int>(), colMap);
+
+  colEdges_.erase(removed);
+
+  ncols_ = ncols1;
+
+  cells_   .resize(uint(nrows_*ncols_));
+  colHash_ .resize(uint(ncols_));
+  colToken_.resize(uint(ncols_));
+
+  changed();
 }
 
+// check if rows have same cells
+template<typename CELL, int N>
 bool
-CTileGrid::
-isValid() const
+CTileGridT<CELL, N>::
+rowsEqual(int r1, int r2) const
 {
-  // grid is valid if square shapes and max of one region per cell value
-  CTileGrid grid1 = *this;
-
-  std::set<int> used;
+  const Cell *cells1 = cells_.data() + r1*ncols_;
+  const Cell *cells2 = cells_.data() + r2*ncols_;
 
-  for (int r = 0; r < grid1.nrows_; ++r) {
-    for (int c = 0; c < grid1.ncols_; ++c) {
-      int id = grid1.cell(r, c);
-      if (id < 0) continue;
+  return std::equal(cells1, cells1 + ncols_, cells2);
+}
 
-      if (used.find(id) != used.end())
-        return false;
+// check if columns have same cells
+template<typename CELL, int N>
+bool
+CTileGridT<CELL, N>::
+colsEqual(int c1, int c2) const
+{
+  for (int r = 0; r < nrows_; ++r) {
+    if (cells_[uint(r*ncols_ + c1)] != cells_[uint(r*ncols_ + c2)])
+      return false;
+  }
 
-      used.insert(id);
+  return true;
+}
 
-      int nr, nc;
+// recalc all row and column hashes (new tokens for added rows/columns)
+template<typename CELL, int N>
+void
+CTileGridT<CELL, N>::
+rehash()
+{
+  while (int(rowToken_.size()) < nrows_) rowToken_.push_back(newToken());
+  while (int(colToken_.size()) < ncols_) colToken_.push_back(newToken());
 
-      bool rc = grid1.getRegion(id, r, c, &nr, &nc);
+  rowToken_.resize(uint(nrows_));
+  colToken_.resize(uint(ncols_));
 
-      if (! rc)
-        return false;
+  rowHash_.assign(uint(nrows_), 0);
+  colHash_.assign(uint(ncols_), 0);
 
-      int r2 = r + nr - 1;
-      int c2 = c + nc - 1;
+  for (int r = 0; r < nrows_; ++r) {
+    for (int c = 0; c < ncols_; ++c) {
+      int v = cells_[uint(r*ncols_ + c)];
 
-      grid1.fill(r, c, r2, c2, -2);
+      rowHash_[uint(r)] += cellHash(v, colToken_[uint(c)]);
+      colHash_[uint(c)] += cellHash(v, rowToken_[uint(r)]);
     }
   }
+}
+
+template<typename CELL, int N>
+bool
+CTileGridT<CELL, N>::
+isValid() const
+{
+  // grid is valid if square shapes and max of one region per cell value
+  // (bounding box of each id is filled by its cells)
+  updateAreas();
+
+  for (uint i = 0; i < areas_.size(); ++i) {
+    const AreaInfo &info = areas_[i];
+
+    if (info.count == 0 || valueId(int(i) - 1) < 0) continue;
+
+    if (! info.isRect())
+      return false;
+  }
 
   return true;
 }
 
 // get region for specified id
+template<typename CELL, int N>
 bool
-CTileGrid::
-getRegion(int id, int r1, int c1, int *nr, int *nc)
+CTileGridT<CELL, N>::
+getRegion(int id, int r1, int c1, int *nr, int *nc) const
 {
   // get extent (nrows, ncols) of area with specified id
+  int v = findValue(id);
+
+  if (v < -1)
+    return false;
+
+  updateAreas();
+
+  const AreaInfo &info = areaInfo(v);
+
+  if (info.count == 0)
+    return false;
+
+  if (r1 < info.r1 || r1 > info.r2 || c1 < info.c1 || c1 > info.c2)
+    return false;
+
+  // rectangular area extends to end of bounding box
+  if (info.isRect()) {
+    *nr = info.r2 - r1 + 1;
+    *nc = info.c2 - c1 + 1;
+
+    return true;
+  }
+
+  // otherwise extend along start row/column and check all cells in range
   int r2 = r1;
   int c2 = c1;
 
@@ -343,8 +929,329 @@ getRegion(int id, int r1, int c1, int *nr, int *nc)
   return true;
 }
 
+// get rectangular regions of all ids
+template<typename CELL, int N>
+void
+CTileGridT<CELL, N>::
+getAreaRegions(AreaRegions &regions) const
+{
+  updateAreas();
+
+  regions.clear();
+
+  for (uint i = 0; i < areas_.size(); ++i) {
+    const AreaInfo &info = areas_[i];
+
+    if (info.count == 0) continue;
+
+    int v  = int(i) - 1;
+    int id = valueId(v);
+
+    if (info.isRect()) {
+      regions.push_back(AreaRegion(id, info.r1, info.c1,
+                                   info.r2 - info.r1 + 1, info.c2 - info.c1 + 1));
+      continue;
+    }
+
+    // split non-rectangular area into regions (from top left of unused cells)
+    // inside its bounding box
+    int nr = info.r2 - info.r1 + 1;
+    int nc = info.c2 - info.c1 + 1;
+
+    std::vector<bool> used(uint(nr*nc), false);
+
+    auto isValue = [&](int r, int c) {
+      return (! used[uint((r - info.r1)*nc + c - info.c1)] && cells_[uint(r*ncols_ + c)] == v);
+    };
+
+    for (int r1 = info.r1; r1 <= info.r2; ++r1) {
+      for (int c1 = info.c1; c1 <= info.c2; ++c1) {
+        if (! isValue(r1, c1)) continue;
+
+        int r2 = r1;
+        int c2 = c1;
+
+        while (r2 < info.r2 && isValue(r2 + 1, c1))
+          ++r2;
+
+        while (c2 < info.c2 && isValue(r1, c2 + 1))
+          ++c2;
+
+        bool filled = true;
+
+        for (int r = r1; filled && r <= r2; ++r)
+          for (int c = c1; filled && c <= c2; ++c)
+            filled = isValue(r, c);
+
+        if (! filled) continue;
+
+        for (int r = r1; r <= r2; ++r)
+          for (int c = c1; c <= c2; ++c)
+            used[uint((r - info.r1)*nc + c - info.c1)] = true;
+
+        regions.push_back(AreaRegion(id, r1, c1, r2 - r1 + 1, c2 - c1 + 1));
+      }
+    }
+  }
+
+  // order by start cell
+  std::sort(regions.begin(), regions.end(),
+            [](const AreaRegion &region1, const AreaRegion &region2) {
+    return (region1.row < region2.row ||
+            (region1.row == region2.row && region1.col < region2.col));
+  });
+}
+
+// get cell value for id (-2 if not in grid)
+template<typename CELL, int N>
+int
+CTileGridT<CELL, N>::
+findValue(int id) const
+{
+  if (id == -1)
+    return -1;
+
+  uint i = idValuePos(id);
+
+  if (i >= idValues_.size() || idValues_[i].id != id)
+    return -2;
+
+  return idValues_[i].value;
+}
+
+// get cell value for id (new value allocated if not in grid)
+template<typename CELL, int N>
+int
+CTileGridT<CELL, N>::
+idValue(int id)
+{
+  int v = findValue(id);
+
+  if (v >= -1)
+    return v;
+
+  if (! freeValues_.empty()) {
+    v = freeValues_.back();
+
+    freeValues_.pop_back();
+
+    ids_[uint(v)] = id;
+  }
+  else {
+    // too many distinct ids for cell type
+    if (ids_.size() > size_t(std::numeric_limits<Cell>::max()))
+      return -2;
+
+    v = int(ids_.size());
+
+    ids_.push_back(id);
+  }
+
+  setIdValue(id, v);
+
+  return v;
+}
+
+// release value of id no longer in grid
+template<typename CELL, int N>
+void
+CTileGridT<CELL, N>::
+freeValue(int v)
+{
+  if (v < 0)
+    return;
+
+  eraseIdValue(ids_[uint(v)]);
+
+  freeValues_.push_back(v);
+}
+
+// get position of id in sorted id values (binary search)
+template<typename CELL, int N>
+uint
+CTileGridT<CELL, N>::
+idValuePos(int id) const
+{
+  auto p = std::lower_bound(idValues_.begin(), idValues_.end(), id,
+    [](const IdValue &idValue, int id1) { return idValue.id < id1; });
+
+  return uint(p - idValues_.begin());
+}
+
+// set cell value of id (keeping id values sorted)
+template<typename CELL, int N>
+void
+CTileGridT<CELL, N>::
+setIdValue(int id, int v)
+{
+  uint i = idValuePos(id);
+
+  if (i < idValues_.size() && idValues_[i].id == id) {
+    idValues_[i].value = v;
+
+    return;
+  }
+
+  IdValue idValue;
+
+  idValue.id    = id;
+  idValue.value = v;
+
+  idValues_.insert(i, idValue);
+}
+
+// remove cell value of id
+template<typename CELL, int N>
+void
+CTileGridT<CELL, N>::
+eraseIdValue(int id)
+{
+  uint i = idValuePos(id);
+
+  if (i < idValues_.size() && idValues_[i].id == id)
+    idValues_.erase(i);
+}
+
+// add n cells inside range to area index (expand bounding box)
+template<typename CELL, int N>
 void
-CTileGrid::
+CTileGridT<CELL, N>::
+addAreaCells(int v, int r1, int c1, int r2, int c2, int n)
+{
+  AreaInfo &info = areaInfo(v);
+
+  if (info.count == 0) {
+    info.r1 = r1; info.c1 = c1;
+    info.r2 = r2; info.c2 = c2;
+  }
+  else {
+    info.r1 = std::min(info.r1, r1); info.c1 = std::min(info.c1, c1);
+    info.r2 = std::max(info.r2, r2); info.c2 = std::max(info.c2, c2);
+  }
+
+  info.count += n;
+}
+
+// remove cells in row span from area index (bounding box is shrunk on next query
+// if edge cell removed)
+template<typename CELL, int N>
+void
+CTileGridT<CELL, N>::
+removeAreaCells(int v, int r, int c1, int c2)
+{
+  AreaInfo &info = areaInfo(v);
+
+  if (info.count == 0)
+    return;
+
+  info.count -= c2 - c1 + 1;
+
+  if (info.count <= 0) {
+    info = AreaInfo();
+
+    freeValue(v);
+
+    return;
+  }
+
+  if (r == info.r1 || r == info.r2 || c1 == info.c1 || c2 == info.c2) {
+    info.shrunk  = true;
+    areasShrunk_ = true;
+  }
+}
+
+// move area bounding boxes to new row/column numbers (empty map is unchanged)
+template<typename CELL, int N>
+void
+CTileGridT<CELL, N>::
+remapAreas(const std::vector<int> &rowMap, const std::vector<int> &colMap)
+{
+  for (auto &info : areas_) {
+    if (info.count == 0) continue;
+
+    if (! rowMap.empty()) {
+      info.r1 = rowMap[uint(info.r1)];
+      info.r2 = rowMap[uint(info.r2)];
+    }
+
+    if (! colMap.empty()) {
+      info.c1 = colMap[uint(info.c1)];
+      info.c2 = colMap[uint(info.c2)];
+    }
+  }
+}
+
+// shrink bounding boxes of areas which had edge cells removed
+// (only cells in old bounding box need to be checked)
+template<typename CELL, int N>
+void
+CTileGridT<CELL, N>::
+updateAreas() const
+{
+  if (! areasShrunk_)
+    return;
+
+  for (uint i = 0; i < areas_.size(); ++i) {
+    AreaInfo &info = areas_[i];
+
+    if (info.count == 0 || ! info.shrunk) continue;
+
+    Cell v = Cell(int(i) - 1);
+
+    int r1 = info.r2, c1 = info.c2;
+    int r2 = info.r1, c2 = info.c1;
+
+    for (int r = info.r1; r <= info.r2; ++r) {
+      const Cell *cells = cells_.data() + r*ncols_;
+
+      for (int c = info.c1; c <= info.c2; ++c) {
+        if (cells[c] != v) continue;
+
+        r1 = std::min(r1, r); c1 = std::min(c1, c);
+        r2 = std::max(r2, r); c2 = std::max(c2, c);
+      }
+    }
+
+    info.r1 = r1; info.c1 = c1;
+    info.r2 = r2; info.c2 = c2;
+
+    info.shrunk = false;
+  }
+
+  areasShrunk_ = false;
+}
+
+// rebuild area index from cells (and release values no longer used)
+template<typename CELL, int N>
+void
+CTileGridT<CELL, N>::
+reindex()
+{
+  areas_.clear();
+
+  areasShrunk_ = false;
+
+  for (int r = 0; r < nrows_; ++r)
+    for (int c = 0; c < ncols_; ++c)
+      addAreaCell(cells_[uint(cellIndex(r, c, ncols_))], r, c);
+
+  idValues_  .clear();
+  freeValues_.clear();
+
+  while (! ids_.empty() && areaInfo(int(ids_.size()) - 1).count == 0)
+    ids_.pop_back();
+
+  for (uint v = 0; v < ids_.size(); ++v) {
+    if (areaInfo(int(v)).count > 0)
+      setIdValue(ids_[v], int(v));
+    else
+      freeValues_.push_back(int(v));
+  }
+}
+
+template<typename CELL, int N>
+void
+CTileGridT<CELL, N>::
 print(std::ostream &os)
 {
   // display new grid
@@ -366,3 +1273,9 @@ print(std::ostream &os)
 
   os << std::endl;
 }
+
+//---
+
+template class CTileGridT<int16_t, 16>;
+template class CTileGridT<int32_t, 16>;
+template class CTileGridT<int16_t, 0>;
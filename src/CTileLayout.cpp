@@ -0,0 +1,1164 @@
+#include <CTileLayout.h>
+#include <CTileConstraintSolver.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+// set layout size (only changed axis needs solve)
+void
+CTileLayout::
+setSize(int w, int h)
+{
+  if (w != width_ ) xdirty_ = true;
+  if (h != height_) ydirty_ = true;
+
+  width_  = w;
+  height_ = h;
+}
+
+// set border
+void
+CTileLayout::
+setBorder(int border)
+{
+  if (border != border_)
+    invalidate();
+
+  border_ = border;
+}
+
+// set splitter size
+void
+CTileLayout::
+setSplitterSize(int size)
+{
+  if (size != splitterSize_)
+    invalidate();
+
+  splitterSize_ = size;
+}
+
+// set minimum size of placement area without an area
+void
+CTileLayout::
+setMinSize(int size)
+{
+  if (size != minSize_)
+    invalidate();
+
+  minSize_ = size;
+}
+
+// set area size constraints (only axes with changed sizes need solve)
+void
+CTileLayout::
+setAreaSizes(const AreaSizes &sizes)
+{
+  if (sizes.size() != areaSizes_.size())
+    invalidate();
+  else {
+    AreaSizes::const_iterator p1 = areaSizes_.begin();
+    AreaSizes::const_iterator p2 = sizes     .begin();
+
+    for ( ; p1 != areaSizes_.end(); ++p1, ++p2) {
+      const AreaSize &size1 = (*p1).second;
+      const AreaSize &size2 = (*p2).second;
+
+      if ((*p1).first != (*p2).first) {
+        invalidate();
+        break;
+      }
+
+      if (size1.minSize.width  != size2.minSize.width  ||
+          size1.maxSize.width  != size2.maxSize.width ) xdirty_ = true;
+      if (size1.minSize.height != size2.minSize.height ||
+          size1.maxSize.height != size2.maxSize.height) ydirty_ = true;
+    }
+  }
+
+  areaSizes_ = sizes;
+}
+
+// set size constraints of single area and update its placement areas
+void
+CTileLayout::
+setAreaSize(int areaId, const AreaSize &size)
+{
+  areaSizes_[areaId] = size;
+
+  uint np = uint(placementAreas_.size());
+
+  for (uint i = 0; i < np; ++i) {
+    if (placementAreas_[i].areaId == areaId)
+      updatePlacementAreaSize(int(i));
+  }
+}
+
+// convert logical grid to physical placement (including splitters)
+bool
+CTileLayout::
+gridToPlacement(bool useExisting, std::vector<int> *invalidIds)
+{
+  int ss = splitterSize_;
+
+  // placement areas are rebuilt so drag spans are invalid
+  endSplitterDrag();
+
+  placementAreas_.clear();
+
+  // get area regions from grid index (ordered by start cell)
+  Grid::AreaRegions regions;
+
+  grid_.getAreaRegions(regions);
+
+  bool valid = true;
+
+  for (const auto &region : regions) {
+    int id = region.id;
+
+    if (id < -1)
+      continue;
+
+    // get area id
+    int areaId = 0;
+
+    if (id > 0) {
+      if (areaSizes_.find(id) != areaSizes_.end())
+        areaId = id;
+      else {
+        // unknown area id so skip region
+        if (invalidIds)
+          invalidIds->push_back(id);
+
+        valid = false;
+
+        continue;
+      }
+    }
+
+    // create placement area for this area
+    PlacementArea placementArea;
+
+    placementArea.place(region.row, region.col, region.nrows, region.ncols, areaId);
+
+    placementAreas_.push_back(placementArea);
+  }
+
+  // keep size of existing rows/columns (new ones get default size) or use same
+  // size for all rows/columns
+  if (useExisting) {
+    bool hasDef = (defWidth_ > 0 && defHeight_ > 0);
+
+    initEdges(grid_.rowEdges(), height_ - 2*border_ + ss, (hasDef ? defHeight_ : -1));
+    initEdges(grid_.colEdges(), width_  - 2*border_ + ss, (hasDef ? defWidth_  : -1));
+  }
+  else {
+    grid_.rowEdges().reset(grid_.nrows());
+    grid_.colEdges().reset(grid_.ncols());
+  }
+
+  updatePlacementAreaIndices();
+
+  addSplitters();
+
+  if (invalidIds) {
+    std::sort(invalidIds->begin(), invalidIds->end());
+
+    invalidIds->erase(std::unique(invalidIds->begin(), invalidIds->end()), invalidIds->end());
+  }
+
+  return valid;
+}
+
+// give new rows/columns the default size (or the average size if no default)
+// and rescale edges to fit
+void
+CTileLayout::
+initEdges(CTileGridEdges &edges, int len, int defSize) const
+{
+  int n = edges.size();
+
+  if (n <= 0)
+    return;
+
+  // edges unchanged if no new rows/columns and already fit
+  if (! edges.hasNew() && edges.pos(0) == 0.0 && edges.pos(n) == 1.0)
+    return;
+
+  // get sizes (fraction of length) with default size for new rows/columns
+  double newSize;
+
+  if (len > 0)
+    newSize = (defSize > 0 ? double(defSize + splitterSize_) : double(len)/std::max(n - 1, 1))/len;
+  else
+    newSize = 1.0/n;
+
+  std::vector<double> sizes(uint(n), 0.0);
+
+  double total = 0.0;
+
+  for (int i = 0; i < n; ++i) {
+    double size = (edges.isNew(i) ? newSize : edges.size(i));
+
+    sizes[uint(i)] = size;
+
+    total += size;
+  }
+
+  if (total <= 0.0) {
+    edges.reset(n);
+    return;
+  }
+
+  double pos = 0.0;
+
+  edges.setPos(0, 0.0);
+
+  for (int i = 0; i < n - 1; ++i) {
+    pos += sizes[uint(i)];
+
+    edges.setPos(i + 1, pos/total);
+  }
+
+  edges.setPos(n, 1.0);
+
+  edges.clearNew();
+}
+
+// add splitters between placement areas.
+// The placement area edges are sorted by row/column and start and touching edges
+// are merged into splitters in a single sweep per row/column. Vertical splitters
+// are split where horizontal splitters cross them in the same sweep.
+void
+CTileLayout::
+addSplitters()
+{
+  hsplitters_.clear();
+  vsplitters_.clear();
+
+  invalidate();
+
+  //------
+
+  // get placement area edges
+  Edges hedges, vedges;
+
+  uint np = uint(placementAreas_.size());
+
+  for (uint i = 0; i < np; ++i) {
+    const PlacementArea &placementArea = placementAreas_[i];
+
+    int row1 = placementArea.row1();
+    int row2 = placementArea.row2();
+    int col1 = placementArea.col1();
+    int col2 = placementArea.col2();
+
+    if (row1 > 0            ) hedges.push_back(Edge(row1, col1, col2, int(i), true ));
+    if (row2 < grid_.nrows()) hedges.push_back(Edge(row2, col1, col2, int(i), false));
+    if (col1 > 0            ) vedges.push_back(Edge(col1, row1, row2, int(i), true ));
+    if (col2 < grid_.ncols()) vedges.push_back(Edge(col2, row1, row2, int(i), false));
+  }
+
+  auto edgeLess = [](const Edge &edge1, const Edge &edge2) {
+    return (edge1.pos < edge2.pos || (edge1.pos == edge2.pos && edge1.start < edge2.start));
+  };
+
+  std::sort(hedges.begin(), hedges.end(), edgeLess);
+  std::sort(vedges.begin(), vedges.end(), edgeLess);
+
+  //------
+
+  // merge touching horizontal edges into splitters and save rows where each
+  // column is crossed by a horizontal splitter (in row order)
+  std::vector<std::vector<int>> colCrossRows(uint(grid_.ncols() + 1));
+
+  uint ne = uint(hedges.size());
+  uint i  = 0;
+
+  while (i < ne) {
+    int row = hedges[i].pos;
+
+    HSplitter splitter;
+
+    splitter.col1 = hedges[i].start;
+    splitter.col2 = hedges[i].end;
+
+    for ( ; i < ne && hedges[i].pos == row && hedges[i].start <= splitter.col2; ++i) {
+      const Edge &edge = hedges[i];
+
+      splitter.col2 = std::max(splitter.col2, edge.end);
+
+      if (edge.after)
+        addAreaSetInd(splitter.bareas, edge.ind);
+      else
+        addAreaSetInd(splitter.tareas, edge.ind);
+    }
+
+    for (int c = splitter.col1 + 1; c < splitter.col2; ++c)
+      colCrossRows[uint(c)].push_back(row);
+
+    hsplitters_[row].push_back(splitter);
+  }
+
+  //------
+
+  // merge touching vertical edges into splitters and split at crossing rows
+  ne = uint(vedges.size());
+  i  = 0;
+
+  while (i < ne) {
+    int col = vedges[i].pos;
+
+    // get edge range and row range of splitter
+    uint i1 = i;
+
+    int row1 = vedges[i].start;
+    int row2 = vedges[i].end;
+
+    for ( ; i < ne && vedges[i].pos == col && vedges[i].start <= row2; ++i)
+      row2 = std::max(row2, vedges[i].end);
+
+    // add splitter pieces between crossing rows
+    VSplitterArray &splitters = vsplitters_[col];
+
+    uint is = uint(splitters.size());
+
+    const std::vector<int> &crossRows = colCrossRows[uint(col)];
+
+    VSplitter splitter;
+
+    splitter.row1 = row1;
+
+    auto pr = std::upper_bound(crossRows.begin(), crossRows.end(), row1);
+
+    for ( ; pr != crossRows.end() && *pr < row2; ++pr) {
+      splitter.row2 = *pr;
+
+      splitters.push_back(splitter);
+
+      splitter.row1 = *pr;
+    }
+
+    splitter.row2 = row2;
+
+    splitters.push_back(splitter);
+
+    // add areas to piece containing area start row (edges are in start row order)
+    for (uint j = i1; j < i; ++j) {
+      const Edge &edge = vedges[j];
+
+      while (is + 1 < splitters.size() && edge.start >= splitters[is].row2)
+        ++is;
+
+      if (edge.after)
+        addAreaSetInd(splitters[is].rareas, edge.ind);
+      else
+        addAreaSetInd(splitters[is].lareas, edge.ind);
+    }
+  }
+}
+
+// add placement area index to sorted area set (if not already present)
+void
+CTileLayout::
+addAreaSetInd(AreaSet &areas, int ind)
+{
+  auto p = std::lower_bound(areas.begin(), areas.end(), ind);
+
+  if (p != areas.end() && *p == ind)
+    return;
+
+  areas.insert(uint(p - areas.begin()), ind);
+}
+
+// adjust placement area sizes to fit new larger/smaller layout size
+void
+CTileLayout::
+adjustToFit()
+{
+  if (xdirty_) {
+    fitWidth();
+
+    xdirty_ = false;
+  }
+
+  if (ydirty_) {
+    fitHeight();
+
+    ydirty_ = false;
+  }
+}
+
+// resize layout and adjust placement areas of changed axes
+void
+CTileLayout::
+resize(int w, int h, std::vector<int> &changed)
+{
+  changed.clear();
+
+  setSize(w, h);
+
+  if (xdirty_) {
+    fitWidth(&changed);
+
+    xdirty_ = false;
+  }
+
+  if (ydirty_) {
+    fitHeight(&changed);
+
+    ydirty_ = false;
+  }
+}
+
+// get size constraints of area
+CTileLayout::AreaSize
+CTileLayout::
+getAreaSize(int areaId) const
+{
+  AreaSizes::const_iterator pa = areaSizes_.find(areaId);
+
+  if (pa != areaSizes_.end())
+    return (*pa).second;
+
+  return AreaSize(Size(minSize_, minSize_));
+}
+
+// set x position of each column edge and update placement x/width
+void
+CTileLayout::
+fitWidth(std::vector<int> *changed)
+{
+  int ss = splitterSize_;
+
+  // refit column edges invalidates drag of column edge
+  if (! drag_.horizontal)
+    endSplitterDrag();
+
+  uint np = uint(placementAreas_.size());
+
+  // get column edges and width constraints of each placement area
+  Spans spans(np);
+
+  for (uint i = 0; i < np; ++i) {
+    const PlacementArea &placementArea = placementAreas_[i];
+
+    Span &span = spans[i];
+
+    span.var1 = placementArea.col1();
+    span.var2 = placementArea.col2();
+
+    AreaSize areaSize = getAreaSize(placementArea.areaId);
+
+    span.minSize = areaSize.minSize.width;
+    span.maxSize = areaSize.maxSize.width;
+  }
+
+  // get edge positions (borders are splitters ending at border)
+  fitEdges(grid_.colEdges(), spans, border_ - ss, width_ - border_, colPos_);
+
+  //---
+
+  uint nc = (changed ? uint(changed->size()) : 0);
+
+  for (uint i = 0; i < np; ++i) {
+    PlacementArea &placementArea = placementAreas_[i];
+
+    int x1 = colPos_[uint(placementArea.col1())] + ss;
+    int x2 = colPos_[uint(placementArea.col2())];
+
+    if (placementArea.x1() == x1 && placementArea.x2() == x2)
+      continue;
+
+    placementArea.x     = x1;
+    placementArea.width = x2 - x1;
+
+    if (changed)
+      changed->push_back(int(i));
+  }
+
+  // merge with previously changed placement areas
+  if (changed && nc > 0 && nc < changed->size()) {
+    std::inplace_merge(changed->begin(), changed->begin() + nc, changed->end());
+
+    changed->erase(std::unique(changed->begin(), changed->end()), changed->end());
+  }
+}
+
+// set y position of each row edge and update placement y/height
+void
+CTileLayout::
+fitHeight(std::vector<int> *changed)
+{
+  int ss = splitterSize_;
+
+  // refit row edges invalidates drag of row edge
+  if (drag_.horizontal)
+    endSplitterDrag();
+
+  uint np = uint(placementAreas_.size());
+
+  // get row edges and height constraints of each placement area
+  Spans spans(np);
+
+  for (uint i = 0; i < np; ++i) {
+    const PlacementArea &placementArea = placementAreas_[i];
+
+    Span &span = spans[i];
+
+    span.var1 = placementArea.row1();
+    span.var2 = placementArea.row2();
+
+    AreaSize areaSize = getAreaSize(placementArea.areaId);
+
+    span.minSize = areaSize.minSize.height;
+    span.maxSize = areaSize.maxSize.height;
+  }
+
+  // get edge positions (borders are splitters ending at border)
+  fitEdges(grid_.rowEdges(), spans, border_ - ss, height_ - border_, rowPos_);
+
+  //---
+
+  uint nc = (changed ? uint(changed->size()) : 0);
+
+  for (uint i = 0; i < np; ++i) {
+    PlacementArea &placementArea = placementAreas_[i];
+
+    int y1 = rowPos_[uint(placementArea.row1())] + ss;
+    int y2 = rowPos_[uint(placementArea.row2())];
+
+    if (placementArea.y1() == y1 && placementArea.y2() == y2)
+      continue;
+
+    placementArea.y      = y1;
+    placementArea.height = y2 - y1;
+
+    if (changed)
+      changed->push_back(int(i));
+  }
+
+  // merge with previously changed placement areas
+  if (changed && nc > 0 && nc < changed->size()) {
+    std::inplace_merge(changed->begin(), changed->begin() + nc, changed->end());
+
+    changed->erase(std::unique(changed->begin(), changed->end()), changed->end());
+  }
+}
+
+// map fractional edges to positions between pos1 and pos2.
+// If the mapped positions do not meet the size constraints of the spans they are
+// used as the preferred positions of a solve (the edges are not changed so the
+// sizes return when the constraints are met again).
+void
+CTileLayout::
+fitEdges(const CTileGridEdges &edges, const Spans &spans, int pos1, int pos2,
+         Positions &pos) const
+{
+  int ss = splitterSize_;
+  int ne = edges.size() + 1;
+
+  pos.resize(uint(ne));
+
+  double len = pos2 - pos1;
+
+  for (int i = 0; i < ne; ++i)
+    pos[uint(i)] = pos1 + int(std::round(edges.pos(i)*len));
+
+  // check constraints
+  bool fit = true;
+
+  for (const auto &span : spans) {
+    int size = pos[uint(span.var2)] - pos[uint(span.var1)] - ss;
+
+    if (size < span.minSize || size > span.maxSize) {
+      fit = false;
+      break;
+    }
+  }
+
+  if (fit)
+    return;
+
+  //---
+
+  // solve whole axis (a fresh solver per solve). The preferred positions are the
+  // mapped edges, which all move when the layout size changes, and a changed span
+  // can push edges up to both borders, so a solve kept from the previous pass would
+  // need to update most variables and bounds anyway
+  CTileConstraintSolver solver;
+
+  for (int i = 0; i < ne; ++i)
+    solver.addVariable(pos[uint(i)]);
+
+  // start border is fixed, end border can grow if minimum sizes do not fit
+  solver.setFixed(0     , pos1);
+  solver.setFixed(ne - 1, pos2, /*weak*/true);
+
+  for (const auto &span : spans) {
+    solver.addMinDistance(span.var1, span.var2, ss + span.minSize);
+
+    if (span.maxSize < INT_MAX - ss)
+      solver.addMaxDistance(span.var1, span.var2, ss + span.maxSize);
+  }
+
+  solver.solve();
+
+  for (int i = 0; i < ne; ++i)
+    pos[uint(i)] = solver.pos(i);
+}
+
+// set inner edges which do not map to their position (solved for constraints)
+// to that position so the edges give the current layout
+void
+CTileLayout::
+syncEdges(CTileGridEdges &edges, const Positions &pos, int pos1, int pos2)
+{
+  int n   = edges.size();
+  int len = pos2 - pos1;
+
+  if (len <= 0 || int(pos.size()) != n + 1)
+    return;
+
+  for (int i = 1; i < n; ++i) {
+    if (pos1 + int(std::round(edges.pos(i)*len)) != pos[uint(i)])
+      edges.setPos(i, double(pos[uint(i)] - pos1)/len);
+  }
+}
+
+// start drag of row edge (all horizontal splitters at row)
+bool
+CTileLayout::
+beginHSplitterDrag(int row)
+{
+  endSplitterDrag();
+
+  if (hsplitters_.find(row) == hsplitters_.end() || ydirty_)
+    return false;
+
+  int ss = splitterSize_;
+
+  // edges of other splitters are set to their current position first if they were
+  // solved to a different position (so they do not jump when dragged edge is set)
+  syncEdges(grid_.rowEdges(), rowPos_, border_ - ss, height_ - border_);
+
+  // get row edges and height constraints of each placement area
+  uint np = uint(placementAreas_.size());
+
+  Spans spans(np);
+
+  for (uint i = 0; i < np; ++i) {
+    const PlacementArea &placementArea = placementAreas_[i];
+
+    Span &span = spans[i];
+
+    span.var1 = placementArea.row1();
+    span.var2 = placementArea.row2();
+
+    AreaSize areaSize = getAreaSize(placementArea.areaId);
+
+    span.minSize = areaSize.minSize.height;
+    span.maxSize = areaSize.maxSize.height;
+  }
+
+  return initSplitterDrag(/*horizontal*/true, row, spans, rowPos_);
+}
+
+// start drag of column edge (all vertical splitters at column)
+bool
+CTileLayout::
+beginVSplitterDrag(int col)
+{
+  endSplitterDrag();
+
+  if (vsplitters_.find(col) == vsplitters_.end() || xdirty_)
+    return false;
+
+  int ss = splitterSize_;
+
+  // edges of other splitters are set to their current position first if they were
+  // solved to a different position (so they do not jump when dragged edge is set)
+  syncEdges(grid_.colEdges(), colPos_, border_ - ss, width_ - border_);
+
+  // get column edges and width constraints of each placement area
+  uint np = uint(placementAreas_.size());
+
+  Spans spans(np);
+
+  for (uint i = 0; i < np; ++i) {
+    const PlacementArea &placementArea = placementAreas_[i];
+
+    Span &span = spans[i];
+
+    span.var1 = placementArea.col1();
+    span.var2 = placementArea.col2();
+
+    AreaSize areaSize = getAreaSize(placementArea.areaId);
+
+    span.minSize = areaSize.minSize.width;
+    span.maxSize = areaSize.maxSize.width;
+  }
+
+  return initSplitterDrag(/*horizontal*/false, col, spans, colPos_);
+}
+
+// init drag of edge.
+// For each direction (0 back, 1 forward) get the spans which push the next edge when
+// they reach their minimum size (a span starting (forward) or ending (back) at a moved
+// edge) and the spans which are only resized by the moved edges, then get the offset
+// range where no span exceeds its maximum size and the border edges do not move.
+bool
+CTileLayout::
+initSplitterDrag(bool horizontal, int edge, const Spans &spans, const Positions &pos)
+{
+  int ss = splitterSize_;
+  int ne = int(pos.size());
+
+  if (edge <= 0 || edge >= ne - 1)
+    return false;
+
+  drag_.horizontal = horizontal;
+  drag_.edge       = edge;
+  drag_.delta      = 0;
+  drag_.startPos   = pos;
+
+  // order spans by start edge (forward push order)
+  uint ns = uint(spans.size());
+
+  std::vector<int> order(ns);
+
+  std::iota(order.begin(), order.end(), 0);
+
+  std::sort(order.begin(), order.end(), [&](int i1, int i2) {
+    return spans[uint(i1)].var1 < spans[uint(i2)].var1;
+  });
+
+  std::vector<bool> moved(uint(ne), false);
+
+  for (int dir = 0; dir < 2; ++dir) {
+    DragSpans &dragSpans = drag_.spans[dir];
+    DragEdges &dragEdges = drag_.edges[dir];
+
+    dragSpans.clear();
+    dragEdges.clear();
+
+    moved.assign(uint(ne), false);
+
+    moved[uint(edge)] = true;
+
+    dragEdges.push_back(edge);
+
+    // add push spans (end edge index is after start edge index so a single pass in
+    // start edge order (forward) or reverse order (back) gets all pushed edges)
+    for (uint i = 0; i < ns; ++i) {
+      int ind = (dir == 1 ? order[i] : order[ns - 1 - i]);
+
+      const Span &span = spans[uint(ind)];
+
+      int e1 = (dir == 1 ? span.var1 : span.var2);
+      int e2 = (dir == 1 ? span.var2 : span.var1);
+
+      if (! moved[uint(e1)])
+        continue;
+
+      DragSpan dragSpan;
+
+      dragSpan.ind  = ind;
+      dragSpan.var1 = span.var1;
+      dragSpan.var2 = span.var2;
+      dragSpan.push = true;
+
+      dragSpans.push_back(dragSpan);
+
+      if (! moved[uint(e2)]) {
+        moved[uint(e2)] = true;
+
+        dragEdges.push_back(e2);
+      }
+    }
+
+    // add spans resized by moved edges
+    for (uint i = 0; i < ns; ++i) {
+      const Span &span = spans[i];
+
+      int e1 = (dir == 1 ? span.var1 : span.var2);
+      int e2 = (dir == 1 ? span.var2 : span.var1);
+
+      if (moved[uint(e1)] || ! moved[uint(e2)])
+        continue;
+
+      DragSpan dragSpan;
+
+      dragSpan.ind  = int(i);
+      dragSpan.var1 = span.var1;
+      dragSpan.var2 = span.var2;
+
+      dragSpans.push_back(dragSpan);
+    }
+
+    // set edge distance range (a span already outside its size range is not resized
+    // back into it)
+    for (auto &dragSpan : dragSpans) {
+      const Span &span = spans[uint(dragSpan.ind)];
+
+      int size = pos[uint(dragSpan.var2)] - pos[uint(dragSpan.var1)];
+
+      dragSpan.minSize = std::min(size, ss + span.minSize);
+
+      if (span.maxSize < INT_MAX - ss)
+        dragSpan.maxSize = std::max(size, ss + span.maxSize);
+    }
+  }
+
+  calcDragRange();
+
+  drag_.active = true;
+
+  return true;
+}
+
+// get largest valid drag offset in each direction (limited by distance to border)
+void
+CTileLayout::
+calcDragRange()
+{
+  const Positions &pos = drag_.startPos;
+
+  int ne   = int(pos.size());
+  int edge = drag_.edge;
+
+  Positions pos1 = pos;
+
+  int lo = 0;
+  int hi = pos[uint(ne - 1)] - pos[uint(edge)];
+
+  while (lo < hi) {
+    int d = hi - (hi - lo)/2;
+
+    if (setDragPositions(d, pos1))
+      lo = d;
+    else
+      hi = d - 1;
+  }
+
+  drag_.maxDelta = lo;
+
+  lo = pos[0] - pos[uint(edge)];
+  hi = 0;
+
+  while (lo < hi) {
+    int d = lo + (hi - lo)/2;
+
+    if (setDragPositions(d, pos1))
+      hi = d;
+    else
+      lo = d + 1;
+  }
+
+  drag_.minDelta = hi;
+}
+
+// set edge positions for drag offset (only drag edges are changed).
+// The dragged edge is moved by the offset and pushes the edges of spans which would
+// be smaller than their minimum size
+bool
+CTileLayout::
+setDragPositions(int d, Positions &pos) const
+{
+  const Positions &startPos = drag_.startPos;
+
+  // reset edges moved by previous offset
+  for (int dir = 0; dir < 2; ++dir) {
+    for (int e : drag_.edges[dir])
+      pos[uint(e)] = startPos[uint(e)];
+  }
+
+  if (d == 0)
+    return true;
+
+  int dir = (d > 0 ? 1 : 0);
+
+  pos[uint(drag_.edge)] += d;
+
+  // push edges (in push order)
+  for (const auto &dragSpan : drag_.spans[dir]) {
+    if (! dragSpan.push)
+      break;
+
+    int &pos1 = pos[uint(dragSpan.var1)];
+    int &pos2 = pos[uint(dragSpan.var2)];
+
+    if (dir == 1)
+      pos2 = std::max(pos2, pos1 + dragSpan.minSize);
+    else
+      pos1 = std::min(pos1, pos2 - dragSpan.minSize);
+  }
+
+  // check border not moved and no span too large
+  int border = (dir == 1 ? int(pos.size()) - 1 : 0);
+
+  if (pos[uint(border)] != startPos[uint(border)])
+    return false;
+
+  for (const auto &dragSpan : drag_.spans[dir]) {
+    if (pos[uint(dragSpan.var2)] - pos[uint(dragSpan.var1)] > dragSpan.maxSize)
+      return false;
+  }
+
+  return true;
+}
+
+// move dragged edge to offset from start position and update moved edges and placement
+// areas of moved spans
+int
+CTileLayout::
+dragSplitter(int d, std::vector<int> &changed)
+{
+  changed.clear();
+
+  if (! drag_.active || (drag_.horizontal ? ydirty_ : xdirty_))
+    return 0;
+
+  d = std::min(std::max(d, drag_.minDelta), drag_.maxDelta);
+
+  if (d == drag_.delta)
+    return d;
+
+  drag_.delta = d;
+
+  int ss = splitterSize_;
+
+  Positions      &pos   = (drag_.horizontal ? rowPos_           : colPos_);
+  CTileGridEdges &edges = (drag_.horizontal ? grid_.rowEdges() : grid_.colEdges());
+
+  setDragPositions(d, pos);
+
+  // update fractional position of moved edges (unchanged if it maps to position)
+  int pos1 = border_ - ss;
+  int len  = (drag_.horizontal ? height_ : width_) - border_ - pos1;
+
+  if (len > 0) {
+    for (int dir = 0; dir < 2; ++dir) {
+      for (int e : drag_.edges[dir]) {
+        if (pos1 + int(std::round(edges.pos(e)*len)) != pos[uint(e)])
+          edges.setPos(e, double(pos[uint(e)] - pos1)/len);
+      }
+    }
+  }
+
+  // update placement areas of moved spans
+  for (int dir = 0; dir < 2; ++dir) {
+    for (const auto &dragSpan : drag_.spans[dir]) {
+      PlacementArea &placementArea = placementAreas_[uint(dragSpan.ind)];
+
+      int p1 = pos[uint(dragSpan.var1)] + ss;
+      int p2 = pos[uint(dragSpan.var2)];
+
+      if (drag_.horizontal) {
+        if (placementArea.y1() == p1 && placementArea.y2() == p2)
+          continue;
+
+        placementArea.y      = p1;
+        placementArea.height = p2 - p1;
+      }
+      else {
+        if (placementArea.x1() == p1 && placementArea.x2() == p2)
+          continue;
+
+        placementArea.x     = p1;
+        placementArea.width = p2 - p1;
+      }
+
+      changed.push_back(dragSpan.ind);
+    }
+  }
+
+  std::sort(changed.begin(), changed.end());
+
+  changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+
+  return d;
+}
+
+// set area id of placement area and update area id lookup
+void
+CTileLayout::
+setPlacementAreaId(int ind, int areaId)
+{
+  PlacementArea &placementArea = placementAreas_[uint(ind)];
+
+  int oldId = placementArea.areaId;
+
+  if (oldId == areaId)
+    return;
+
+  placementArea.areaId = areaId;
+
+  // area size constraints change with area
+  updatePlacementAreaSize(ind);
+
+  // move old id lookup to next placement area with same id (if any)
+  if (getPlacementAreaIndex(oldId) == ind) {
+    int ind1 = -1;
+
+    for (uint i = uint(ind) + 1; i < placementAreas_.size(); ++i) {
+      if (placementAreas_[i].areaId == oldId) {
+        ind1 = int(i);
+        break;
+      }
+    }
+
+    areaIndices_[uint(oldId)] = ind1;
+  }
+
+  // set new id lookup (first placement area for id)
+  if (areaId >= 0) {
+    if (uint(areaId) >= areaIndices_.size())
+      areaIndices_.resize(uint(areaId) + 1, -1);
+
+    int ind1 = areaIndices_[uint(areaId)];
+
+    if (ind1 < 0 || ind < ind1)
+      areaIndices_[uint(areaId)] = ind;
+  }
+}
+
+// update size constraints of placement area for its (new) area. Positions stay
+// valid if the placement area fits its new size range, else the edges of the axis
+// it does not fit are solved again. Spans of an active drag get the new range.
+void
+CTileLayout::
+updatePlacementAreaSize(int ind)
+{
+  const PlacementArea &placementArea = placementAreas_[uint(ind)];
+
+  AreaSize areaSize = getAreaSize(placementArea.areaId);
+
+  if (placementArea.width  < areaSize.minSize.width  ||
+      placementArea.width  > areaSize.maxSize.width ) xdirty_ = true;
+  if (placementArea.height < areaSize.minSize.height ||
+      placementArea.height > areaSize.maxSize.height) ydirty_ = true;
+
+  if (! drag_.active || (drag_.horizontal ? ydirty_ : xdirty_))
+    return;
+
+  int ss = splitterSize_;
+
+  int minSize = (drag_.horizontal ? areaSize.minSize.height : areaSize.minSize.width);
+  int maxSize = (drag_.horizontal ? areaSize.maxSize.height : areaSize.maxSize.width);
+
+  bool changed = false;
+
+  for (int dir = 0; dir < 2; ++dir) {
+    for (auto &dragSpan : drag_.spans[dir]) {
+      if (dragSpan.ind != ind) continue;
+
+      int size = drag_.startPos[uint(dragSpan.var2)] - drag_.startPos[uint(dragSpan.var1)];
+
+      dragSpan.minSize = std::min(size, ss + minSize);
+      dragSpan.maxSize = (maxSize < INT_MAX - ss ? std::max(size, ss + maxSize) : INT_MAX);
+
+      changed = true;
+    }
+  }
+
+  if (changed)
+    calcDragRange();
+}
+
+// rebuild area id to placement area index lookup
+void
+CTileLayout::
+updatePlacementAreaIndices()
+{
+  areaIndices_.clear();
+
+  uint np = uint(placementAreas_.size());
+
+  for (uint i = 0; i < np; ++i) {
+    int areaId = placementAreas_[i].areaId;
+    if (areaId < 0) continue;
+
+    if (uint(areaId) >= areaIndices_.size())
+      areaIndices_.resize(uint(areaId) + 1, -1);
+
+    // keep first placement area for id
+    if (areaIndices_[uint(areaId)] < 0)
+      areaIndices_[uint(areaId)] = int(i);
+  }
+}
+
+// get bounding box of horizontal specified splitter
+CTileLayout::Rect
+CTileLayout::
+getHSplitterRect(const HSplitter &splitter) const
+{
+  int ss = splitterSize_;
+
+  int x1 = INT_MAX, x2 = INT_MIN, yt = INT_MIN, yb = INT_MAX;
+
+  for (AreaSet::const_iterator pt = splitter.tareas.begin(); pt != splitter.tareas.end(); ++pt) {
+    int pid = *pt;
+
+    const PlacementArea &placementArea = placementAreas_[uint(pid)];
+
+    yt = std::max(yt, placementArea.y2());
+
+    x1 = std::min(x1, placementArea.x1());
+    x2 = std::max(x2, placementArea.x2());
+  }
+
+  for (AreaSet::const_iterator pb = splitter.bareas.begin(); pb != splitter.bareas.end(); ++pb) {
+    int pid = *pb;
+
+    const PlacementArea &placementArea = placementAreas_[uint(pid)];
+
+    yb = std::min(yb, placementArea.y1());
+
+    x1 = std::min(x1, placementArea.x1());
+    x2 = std::max(x2, placementArea.x2());
+  }
+
+  if (yt == INT_MIN) yt = yb - ss;
+  if (yb == INT_MAX) yb = yt + ss;
+
+  return Rect(x1, (yt + yb)/2 - ss/2, x2 - x1, ss);
+}
+
+// get bounding box of vertical specified splitter
+CTileLayout::Rect
+CTileLayout::
+getVSplitterRect(const VSplitter &splitter) const
+{
+  int ss = splitterSize_;
+
+  int y1 = INT_MAX, y2 = INT_MIN, xl = INT_MIN, xr = INT_MAX;
+
+  for (AreaSet::const_iterator pl = splitter.lareas.begin(); pl != splitter.lareas.end(); ++pl) {
+    int pid = *pl;
+
+    const PlacementArea &placementArea = placementAreas_[uint(pid)];
+
+    xl = std::max(xl, placementArea.x2());
+
+    y1 = std::min(y1, placementArea.y1());
+    y2 = std::max(y2, placementArea.y2());
+  }
+
+  for (AreaSet::const_iterator pr = splitter.rareas.begin(); pr != splitter.rareas.end(); ++pr) {
+    int pid = *pr;
+
+    const PlacementArea &placementArea = placementAreas_[uint(pid)];
+
+    xr = std::min(xr, placementArea.x1());
+
+    y1 = std::min(y1, placementArea.y1());
+    y2 = std::max(y2, placementArea.y2());
+  }
+
+  if (xl == INT_MIN) xl = xr - ss;
+  if (xr == INT_MAX) xr = xl + ss;
+
+  return Rect((xl + xr)/2 - ss/2, y1, ss, y2 - y1);
+}
@@ -0,0 +1,145 @@
+#include <CTileRectIndex.h>
+#include <algorithm>
+#include <climits>
+
+// create index
+CTileRectIndex::
+CTileRectIndex(int bucketSize) :
+ bucketSize_(std::max(bucketSize, 1))
+{
+}
+
+// reset to n empty rectangles
+void
+CTileRectIndex::
+reset(int n)
+{
+  rects_.assign(uint(n), Rect());
+
+  indexValid_ = false;
+}
+
+// set rectangle (invalidates index if changed)
+void
+CTileRectIndex::
+setRect(int i, const Rect &rect)
+{
+  Rect &rect1 = rects_[uint(i)];
+
+  if (rect1 == rect)
+    return;
+
+  rect1 = rect;
+
+  indexValid_ = false;
+}
+
+// get first rectangle containing point
+int
+CTileRectIndex::
+find(int x, int y) const
+{
+  updateIndex();
+
+  int bx = (x - bx_)/bucketSize_;
+  int by = (y - by_)/bucketSize_;
+
+  if (x < bx_ || y < by_ || bx >= nbx_ || by >= nby_)
+    return -1;
+
+  const Inds &inds = buckets_[uint(by*nbx_ + bx)];
+
+  for (int i : inds) {
+    if (rects_[uint(i)].inside(x, y))
+      return i;
+  }
+
+  return -1;
+}
+
+// get indices of rectangles overlapping rectangle (from buckets overlapping rectangle)
+void
+CTileRectIndex::
+findOverlapping(const Rect &rect, std::vector<int> &inds) const
+{
+  inds.clear();
+
+  updateIndex();
+
+  if (rect.isEmpty() || nbx_ == 0 || nby_ == 0)
+    return;
+
+  // clip to buckets
+  int x1 = std::max(rect.x - bx_, 0), x2 = rect.x + rect.width  - 1 - bx_;
+  int y1 = std::max(rect.y - by_, 0), y2 = rect.y + rect.height - 1 - by_;
+
+  if (x2 < 0 || y2 < 0)
+    return;
+
+  int bx1 = x1/bucketSize_, bx2 = std::min(x2/bucketSize_, nbx_ - 1);
+  int by1 = y1/bucketSize_, by2 = std::min(y2/bucketSize_, nby_ - 1);
+
+  for (int by = by1; by <= by2; ++by) {
+    for (int bx = bx1; bx <= bx2; ++bx) {
+      for (int i : buckets_[uint(by*nbx_ + bx)]) {
+        if (rects_[uint(i)].overlaps(rect))
+          inds.push_back(i);
+      }
+    }
+  }
+
+  // rectangle in multiple buckets is found more than once
+  std::sort(inds.begin(), inds.end());
+
+  inds.erase(std::unique(inds.begin(), inds.end()), inds.end());
+}
+
+// rebuild bucket index over bounding box of non-empty rectangles (if needed)
+void
+CTileRectIndex::
+updateIndex() const
+{
+  if (indexValid_)
+    return;
+
+  int x1 = INT_MAX, y1 = INT_MAX, x2 = INT_MIN, y2 = INT_MIN;
+
+  for (const auto &rect : rects_) {
+    if (rect.isEmpty()) continue;
+
+    x1 = std::min(x1, rect.x); x2 = std::max(x2, rect.x + rect.width );
+    y1 = std::min(y1, rect.y); y2 = std::max(y2, rect.y + rect.height);
+  }
+
+  buckets_.clear();
+
+  if (x1 > x2) {
+    bx_  = 0; by_  = 0;
+    nbx_ = 0; nby_ = 0;
+  }
+  else {
+    bx_  = x1;
+    by_  = y1;
+    nbx_ = (x2 - x1 + bucketSize_ - 1)/bucketSize_;
+    nby_ = (y2 - y1 + bucketSize_ - 1)/bucketSize_;
+
+    buckets_.resize(uint(nbx_*nby_));
+
+    // add in index order so first match in bucket is lowest index
+    int n = size();
+
+    for (int i = 0; i < n; ++i) {
+      const Rect &rect = rects_[uint(i)];
+      if (rect.isEmpty()) continue;
+
+      int bx1 = (rect.x - bx_)/bucketSize_, bx2 = (rect.x + rect.width  - 1 - bx_)/bucketSize_;
+      int by1 = (rect.y - by_)/bucketSize_, by2 = (rect.y + rect.height - 1 - by_)/bucketSize_;
+
+      for (int by = by1; by <= by2; ++by)
+        for (int bx = bx1; bx <= bx2; ++bx)
+          buckets_[uint(by*nbx_ + bx)].push_back(i);
+    }
+  }
+
+  indexValid_ = true;
+}
@@ -79,8 +79,13 @@ CQTileAreaTest() :
     "One", "Two", "Three", "Four", "Five", "Six", "Seven", "Eight", "Nine"
   };
 
+  // add all windows with a single placement update
+  area_->beginLayoutChange();
+
   for (int i = 0; i < 9; ++i)
     area_->addWindow(new ButtonWindow(names[i]), i / 3, i % 3);
+
+  area_->endLayoutChange();
 }
 
 void
@@ -25,4 +25,4 @@ INCLUDEPATH += \
 
 unix:LIBS += \
 -L../lib -L../../CQTitleBar/lib \
--lCQTileArea -lCQTitleBar
+-lCQTileArea -lCTileLayout -lCQTitleBar